@@ -2,18 +2,69 @@
 
 import argparse
 import os
+import re
 
 parser = argparse.ArgumentParser(description="Embeds GLSL Shaders into a C++ source file.")
 parser.add_argument("sourcedir", help="The directory containing all the shaders.")
 parser.add_argument("outdir", help="The directory to generate the source file.")
 args = parser.parse_args()
 
+# plain uniforms only, uniform blocks are matched by blockPattern
+uniformPattern = re.compile(r"^\s*uniform\s+(?:(?:lowp|mediump|highp)\s+)?(\w+)\s+(\w+)\s*(?:\[[^\]]*\])?\s*;", re.MULTILINE)
+blockPattern = re.compile(r"\buniform\s+(\w+)\s*\{")
+
+
+# where each field of a packed BlockVertex goes: (word, field, first bit, bits). BlockVertexLayout.h has these
+# for the C++ side and every shader using them gets them as BLOCK_VERTEX_<FIELD>_SHIFT and _MASK constants,
+# so packing and decoding can't disagree.
+blockVertexLayout = [
+    ("position", "x", 0, 5),
+    ("position", "y", 5, 5),
+    ("position", "z", 10, 5),
+    ("position", "face", 15, 3),
+    ("material", "texture", 0, 16),
+    ("material", "light", 16, 8),
+]
+
+usedBits = {}
+for word, field, shift, bits in blockVertexLayout:
+    fieldBits = ((1 << bits) - 1) << shift
+    if shift + bits > 32 or usedBits.get(word, 0) & fieldBits:
+        raise SystemExit("BlockVertex field '" + field + "' doesn't fit into " + word)
+    usedBits[word] = usedBits.get(word, 0) | fieldBits
+
+
+def blockVertexConstants(indent, declaration, prefix, valueSuffix):
+    constants = []
+    for word, field, shift, bits in blockVertexLayout:
+        constants.append(indent + "// " + field + ", in " + word + "\n")
+        constants.append(indent + declaration + " " + prefix + field.upper() + "_SHIFT = " + str(shift) + valueSuffix
+                         + ";\n")
+        constants.append(indent + declaration + " " + prefix + field.upper() + "_MASK = " + str((1 << bits) - 1)
+                         + valueSuffix + ";\n")
+    return constants
+
+
+def enumName(uniformName):
+    # projectionMatrix -> PROJECTION_MATRIX
+    return re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", uniformName).upper()
+
 
 sourceCodeList = ["// Autogenerated source code files.\n\n", "namespace Shaders {\n"]
+# name to (type, files it's declared in), in the order they were first found
+uniforms = {}
+# block name to the files it's declared in
+blocks = {}
 for root, dirs, files in os.walk(args.sourcedir):
-    for shaderFileName in files:
+    dirs.sort()
+    for shaderFileName in sorted(files):
         shaderFilePath = os.path.join(root, shaderFileName)
         shaderSource = open(shaderFilePath, "r").read()
+        if "BLOCK_VERTEX_" in shaderSource:
+            # right after #version, which has to come first
+            versionEnd = shaderSource.index("\n", shaderSource.index("#version")) + 1
+            shaderSource = (shaderSource[:versionEnd] + "\n// generated from GenerateShaders.py, see BlockVertexLayout.h\n"
+                            + "".join(blockVertexConstants("", "const uint", "BLOCK_VERTEX_", "u")) + shaderSource[versionEnd:])
 
         shaderName = shaderFileName.split(".")[0]
         sourceCodeList.append('    // ' + shaderFileName + "\n")
@@ -21,14 +72,71 @@ for root, dirs, files in os.walk(args.sourcedir):
         sourceCodeList.append(shaderSource)
         sourceCodeList.append(')";\n    \n')
 
+        for uniformType, uniformName in uniformPattern.findall(shaderSource):
+            if uniformName in uniforms and uniforms[uniformName][0] != uniformType:
+                raise SystemExit("Uniform '" + uniformName + "' is declared as both " + uniforms[uniformName][0]
+                                 + " and " + uniformType)
+            uniforms.setdefault(uniformName, (uniformType, []))[1].append(shaderFileName)
+        for blockName in blockPattern.findall(shaderSource):
+            blocks.setdefault(blockName, []).append(shaderFileName)
+
 sourceCodeList.append("}\n")
 sourceCode = "".join(sourceCodeList)
 
+headerList = ["// Autogenerated from the uniforms declared in the shaders.\n\n", "#pragma once\n\n",
+              "// every uniform of every shader, see Shader::set\n", "enum class Uniform {\n"]
+for uniformName, (uniformType, shaderFiles) in uniforms.items():
+    headerList.append("    " + enumName(uniformName) + ", // " + uniformType + " in " + ", ".join(shaderFiles) + "\n")
+headerList.append("    COUNT\n};\n\n")
+headerList.append("// every uniform block of every shader. each one is bound to the binding point of its value.\n")
+headerList.append("enum class UniformBlock {\n")
+for blockName, shaderFiles in blocks.items():
+    headerList.append("    " + enumName(blockName) + ", // in " + ", ".join(shaderFiles) + "\n")
+headerList.append("    COUNT\n};\n\n")
+headerList.append("namespace Shaders {\n")
+headerList.append("    // the name of each uniform in GLSL, indexed by Uniform\n")
+headerList.append("    constexpr const char *uniformNames[] = {\n")
+for uniformName in uniforms:
+    headerList.append('        "' + uniformName + '",\n')
+headerList.append("    };\n\n")
+headerList.append("    // the texture unit each sampler is always set to, -1 for other uniforms. indexed by Uniform.\n")
+headerList.append("    constexpr int uniformTextureUnits[] = {\n")
+textureUnits = 0
+for uniformName, (uniformType, shaderFiles) in uniforms.items():
+    if re.match(r"[iu]?sampler", uniformType):
+        headerList.append("        " + str(textureUnits) + ", // " + uniformName + "\n")
+        textureUnits += 1
+    else:
+        headerList.append("        -1,\n")
+headerList.append("    };\n\n")
+headerList.append("    // every sampler has a unit of its own, so samplers of different types never share one\n")
+headerList.append("    constexpr int textureUnit(Uniform sampler) {\n")
+headerList.append("        return uniformTextureUnits[static_cast<int>(sampler)];\n")
+headerList.append("    }\n\n")
+headerList.append("    // the name of each uniform block in GLSL, indexed by UniformBlock\n")
+headerList.append("    constexpr const char *uniformBlockNames[] = {\n")
+for blockName in blocks:
+    headerList.append('        "' + blockName + '",\n')
+headerList.append("    };\n")
+headerList.append("}\n")
+header = "".join(headerList)
+
+layoutList = ["// Autogenerated from blockVertexLayout in GenerateShaders.py, the shaders get the same constants.\n\n",
+              "#pragma once\n\n", "#include <cstdint>\n\n",
+              "// where each field of a packed BlockVertex goes, see BlockVertex.h\n", "namespace BlockVertexLayout {\n"]
+layoutList += blockVertexConstants("    ", "constexpr std::uint32_t", "", "")
+layoutList.append("}\n")
+layout = "".join(layoutList)
+
 
 outputDir = args.outdir
 outputFile = os.path.join(outputDir, "ShaderSources.cpp")
+headerFile = os.path.join(outputDir, "ShaderUniforms.h")
+layoutFile = os.path.join(outputDir, "BlockVertexLayout.h")
 if not os.path.exists(outputDir):
     os.mkdir(outputDir)
 open(outputFile, "w").write(sourceCode)
+open(headerFile, "w").write(header)
+open(layoutFile, "w").write(layout)
 
 print("Generated shader files.")
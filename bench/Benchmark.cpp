@@ -0,0 +1,173 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+double Benchmark::Result::seconds() const {
+    return std::accumulate(samples.begin(), samples.end(), 0.0);
+}
+
+double Benchmark::Result::throughput() const {
+    double total = seconds();
+    return total > 0.0 ? static_cast<double>(operations) / total : 0.0;
+}
+
+double Benchmark::Result::latency(double percentile) const {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    // nearest rank
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    auto rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+Benchmark::Benchmark(std::string name, std::string unit) {
+    _result.name = std::move(name);
+    _result.unit = std::move(unit);
+}
+
+void Benchmark::metric(const std::string &name, double value) {
+    _result.metrics.emplace_back(name, value);
+}
+
+void Benchmark::skip(const std::string &reason) {
+    _result.skipped = reason;
+}
+
+void Benchmark::fail(const std::string &error) {
+    _result.error = error;
+}
+
+void Benchmark::setPeakRss(std::size_t bytes) {
+    _result.peakRssBytes = bytes;
+}
+
+const Benchmark::Result &Benchmark::result() const {
+    return _result;
+}
+
+namespace {
+    void writeString(std::ostream &out, const std::string &string) {
+        out << '"';
+        for (char c : string) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (c == '\n') {
+                out << "\\n";
+            } else if (static_cast<unsigned char>(c) >= 0x20) {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    // JSON has no infinity or NaN
+    void writeNumber(std::ostream &out, double value) {
+        if (std::isfinite(value)) {
+            out << value;
+        } else {
+            out << "null";
+        }
+    }
+}
+
+namespace BenchmarkReport {
+    void resetPeakRss() {
+#ifdef __linux__
+        // "5" resets VmHWM in /proc/self/status, kernels before 4.0 don't know it and the peak just keeps going
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+#endif
+    }
+
+    std::size_t peakRss() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+#else
+#ifdef __linux__
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmHWM:") == 0) {
+                return std::stoull(line.substr(6)) * 1024;
+            }
+        }
+#endif
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    void writeJson(std::ostream &out, const std::vector<std::pair<std::string, std::string>> &info,
+        const std::vector<Benchmark::Result> &results) {
+        out << std::setprecision(9) << "{\n";
+        for (const auto &[key, value] : info) {
+            out << "  ";
+            writeString(out, key);
+            out << ": ";
+            writeString(out, value);
+            out << ",\n";
+        }
+        out << "  \"scenarios\": [";
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const Benchmark::Result &result = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+            writeString(out, result.name);
+            out << ", \"unit\": ";
+            writeString(out, result.unit);
+            if (!result.skipped.empty()) {
+                out << ", \"skipped\": ";
+                writeString(out, result.skipped);
+            }
+            if (!result.error.empty()) {
+                out << ", \"error\": ";
+                writeString(out, result.error);
+            }
+            out << ",\n     \"operations\": " << result.operations << ", \"samples\": " << result.samples.size()
+                << ", \"operations_per_sample\": " << result.operationsPerSample << ", \"seconds\": ";
+            writeNumber(out, result.seconds());
+            out << ", \"throughput\": ";
+            writeNumber(out, result.throughput());
+            out << ",\n     \"latency_ms\": {\"p50\": ";
+            writeNumber(out, result.latency(50.0) * 1000.0);
+            out << ", \"p99\": ";
+            writeNumber(out, result.latency(99.0) * 1000.0);
+            out << ", \"max\": ";
+            writeNumber(out, result.latency(100.0) * 1000.0);
+            out << "}, \"peak_rss_bytes\": " << result.peakRssBytes << ",\n     \"metrics\": {";
+            for (std::size_t j = 0; j < result.metrics.size(); j++) {
+                out << (j == 0 ? "" : ", ");
+                writeString(out, result.metrics[j].first);
+                out << ": ";
+                writeNumber(out, result.metrics[j].second);
+            }
+            out << "}}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One run of a scenario. The scenario does its setup however it likes and only wraps the work being measured
+// in time(), once per sample, so setup never counts. A sample can stand for several operations, for work
+// too quick to time one at a time.
+class Benchmark {
+public:
+    struct Result {
+        std::string name;
+        // what an operation is, like "sections" or "rays"
+        std::string unit;
+        std::size_t operations{0};
+        // of every sample, in seconds
+        std::vector<double> samples{};
+        std::size_t operationsPerSample{0};
+        // anything else worth keeping, in the order it was added
+        std::vector<std::pair<std::string, double>> metrics{};
+        // the most memory the process held while the scenario ran, 0 if that isn't known
+        std::size_t peakRssBytes{0};
+        // set instead of samples when the scenario couldn't run here
+        std::string skipped{};
+        std::string error{};
+
+        double seconds() const;
+        double throughput() const;
+        // of the samples, in seconds. percentile is 0 to 100.
+        double latency(double percentile) const;
+    };
+
+private:
+    Result _result;
+
+public:
+    Benchmark(std::string name, std::string unit);
+
+    template<typename Function>
+    void time(Function &&function, std::size_t operations = 1) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        _result.samples.push_back(std::chrono::duration<double>(end - start).count());
+        _result.operations += operations;
+        _result.operationsPerSample = operations;
+    }
+
+    void metric(const std::string &name, double value);
+    void skip(const std::string &reason);
+    void fail(const std::string &error);
+    void setPeakRss(std::size_t bytes);
+
+    const Result &result() const;
+};
+
+namespace BenchmarkReport {
+    // the peak only covers what comes after, where the OS lets it be reset (Linux). elsewhere it's the
+    // peak since the process started.
+    void resetPeakRss();
+    std::size_t peakRss();
+
+    void writeJson(std::ostream &out, const std::vector<std::pair<std::string, std::string>> &info,
+        const std::vector<Benchmark::Result> &results);
+}
@@ -0,0 +1,538 @@
+#include "Scenarios.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+#include "Camera.h"
+#include "ChunkStreamer.h"
+#include "Fixtures.h"
+#include "JobSystem.h"
+#include "LightEngine.h"
+#include "Mesher.h"
+#include "Noise.h"
+#include "Raycast.h"
+#include "TerrainGenerator.h"
+#include "World.h"
+#include "WorldStorage.h"
+
+namespace fs = std::filesystem;
+
+using Fixtures::SEED;
+using Fixtures::generate;
+using Fixtures::generateLit;
+using Fixtures::scaled;
+using Fixtures::square;
+
+namespace {
+    constexpr BlockId MIXED_BLOCKS[] = {Blocks::AIR, Blocks::STONE, Blocks::DIRT, Blocks::GRASS, Blocks::SAND,
+        Blocks::WATER, Blocks::LOG, Blocks::LEAVES};
+
+    int surfaceHeight(const World &world, int x, int z) {
+        for (int y = TerrainGenerator::COLUMN_HEIGHT - 1; y > 0; y--) {
+            if (world.getBlock({x, y, z}) != Blocks::AIR) {
+                return y;
+            }
+        }
+        return 0;
+    }
+
+    void sectionSet(Benchmark &benchmark, const BenchOptions &options) {
+        std::mt19937 random(SEED);
+        std::uniform_int_distribution<int> coordinate(0, ChunkSection::SIZE - 1);
+        std::uniform_int_distribution<std::size_t> block(0, std::size(MIXED_BLOCKS) - 1);
+        std::vector<std::array<int, 4>> writes(ChunkSection::VOLUME);
+        for (auto &write : writes) {
+            write = {coordinate(random), coordinate(random), coordinate(random),
+                static_cast<int>(MIXED_BLOCKS[block(random)])};
+        }
+
+        std::size_t samples = scaled(options, 512);
+        for (std::size_t i = 0; i < samples; i++) {
+            // a fresh section every time, so the palette grows through every bit width
+            ChunkSection section;
+            benchmark.time([&]() {
+                for (const auto &[x, y, z, id] : writes) {
+                    section.set(x, y, z, static_cast<BlockId>(id));
+                }
+            }, writes.size());
+            if (i + 1 == samples) {
+                benchmark.metric("bits_per_block", section.bitsPerBlock());
+            }
+        }
+    }
+
+    void sectionGet(Benchmark &benchmark, const BenchOptions &options) {
+        std::mt19937 random(SEED);
+        std::uniform_int_distribution<int> coordinate(0, ChunkSection::SIZE - 1);
+        std::uniform_int_distribution<std::size_t> block(0, std::size(MIXED_BLOCKS) - 1);
+        std::vector<BlockId> blocks(ChunkSection::VOLUME);
+        for (auto &id : blocks) {
+            id = MIXED_BLOCKS[block(random)];
+        }
+        ChunkSection section(blocks.data());
+        std::vector<std::array<int, 3>> reads(ChunkSection::VOLUME);
+        for (auto &read : reads) {
+            read = {coordinate(random), coordinate(random), coordinate(random)};
+        }
+
+        unsigned int sum = 0;
+        for (std::size_t i = 0, samples = scaled(options, 2048); i < samples; i++) {
+            benchmark.time([&]() {
+                for (const auto &[x, y, z] : reads) {
+                    sum += section.get(x, y, z);
+                }
+            }, reads.size());
+        }
+        // keeps the reads from being optimized away
+        benchmark.metric("checksum", sum);
+    }
+
+    void noise(Benchmark &benchmark, const BenchOptions &options, Noise::Isa isa) {
+        if (!Noise::isSupported(isa)) {
+            benchmark.skip(std::string(Noise::isaName(isa)) + " isn't supported by this CPU or build");
+            return;
+        }
+        // what the terrain generator's cave noise samples for one column
+        Noise::FbmSettings settings{SEED, 4, 1.0f / 32.0f, 2.0f, 0.5f};
+        constexpr int SIZE_X = ChunkSection::SIZE;
+        constexpr int SIZE_Y = TerrainGenerator::COLUMN_HEIGHT;
+        constexpr int SIZE_Z = ChunkSection::SIZE;
+        std::vector<float> out(SIZE_X * SIZE_Y * SIZE_Z);
+        for (std::size_t i = 0, samples = scaled(options, 256); i < samples; i++) {
+            int originX = static_cast<int>(i % 16) * SIZE_X;
+            int originZ = static_cast<int>(i / 16) * SIZE_Z;
+            benchmark.time([&]() {
+                Noise::fbm3D(isa, settings, originX, 0, originZ, SIZE_X, SIZE_Y, SIZE_Z, out.data());
+            }, out.size());
+        }
+        benchmark.metric("octaves", settings.octaves);
+    }
+
+    void noiseScalar(Benchmark &benchmark, const BenchOptions &options) {
+        noise(benchmark, options, Noise::Isa::SCALAR);
+    }
+
+    void noiseSse41(Benchmark &benchmark, const BenchOptions &options) {
+        noise(benchmark, options, Noise::Isa::SSE41);
+    }
+
+    void noiseAvx2(Benchmark &benchmark, const BenchOptions &options) {
+        noise(benchmark, options, Noise::Isa::AVX2);
+    }
+
+    // every instruction set has to give exactly the scalar kernel's bits, or terrain would depend on the CPU
+    void noiseMatch(Benchmark &benchmark, const BenchOptions &options) {
+        Noise::FbmSettings settings{SEED, 5, 1.0f / 24.0f, 2.0f, 0.5f};
+        // widths that aren't a multiple of 4 or 8 go through the scalar tail of the vector kernels
+        constexpr std::array<int, 7> WIDTHS = {1, 3, 7, 8, 13, 16, 37};
+        std::size_t grids = 0;
+        std::size_t mismatches = 0;
+        std::string firstMismatch;
+        for (auto isa : {Noise::Isa::SSE41, Noise::Isa::AVX2}) {
+            if (!Noise::isSupported(isa)) {
+                continue;
+            }
+            for (std::size_t i = 0, samples = scaled(options, 8); i < samples; i++) {
+                // negative origins too, where flooring differs from truncating
+                int originX = static_cast<int>(i) * 29 - 100;
+                int originZ = 57 - static_cast<int>(i) * 41;
+                for (int width : WIDTHS) {
+                    std::vector<float> expected(static_cast<std::size_t>(width) * 5 * 9);
+                    std::vector<float> actual(expected.size());
+                    bool matches = true;
+                    benchmark.time([&]() {
+                        Noise::fbm2D(Noise::Isa::SCALAR, settings, originX, originZ, width, 9, expected.data());
+                        Noise::fbm2D(isa, settings, originX, originZ, width, 9, actual.data());
+                        matches = std::memcmp(expected.data(), actual.data(), width * 9 * sizeof(float)) == 0;
+                        Noise::fbm3D(Noise::Isa::SCALAR, settings, originX, -3, originZ, width, 5, 9, expected.data());
+                        Noise::fbm3D(isa, settings, originX, -3, originZ, width, 5, 9, actual.data());
+                        matches = matches
+                            && std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(float)) == 0;
+                    });
+                    grids += 2;
+                    if (!matches) {
+                        mismatches++;
+                        if (firstMismatch.empty()) {
+                            firstMismatch = std::string(Noise::isaName(isa)) + " differs from scalar at origin "
+                                + std::to_string(originX) + ", " + std::to_string(originZ) + " with width "
+                                + std::to_string(width);
+                        }
+                    }
+                }
+            }
+        }
+        if (grids == 0) {
+            benchmark.skip("only the scalar kernel is supported by this CPU or build");
+            return;
+        }
+        benchmark.metric("grids_compared", static_cast<double>(grids));
+        benchmark.metric("mismatches", static_cast<double>(mismatches));
+        if (mismatches > 0) {
+            benchmark.fail(firstMismatch);
+        }
+    }
+
+    void generateColumns(Benchmark &benchmark, const BenchOptions &options) {
+        TerrainGenerator generator(SEED);
+        std::size_t count = scaled(options, 128);
+        for (std::size_t i = 0; i < count; i++) {
+            auto x = static_cast<int>(i % 16);
+            auto z = static_cast<int>(i / 16);
+            benchmark.time([&]() {
+                World::Column column = generator.generateColumn(x, z);
+            });
+        }
+    }
+
+    void generateParallel(Benchmark &benchmark, const BenchOptions &options) {
+        TerrainGenerator generator(SEED);
+        JobSystem jobs(options.workers);
+        std::vector<glm::ivec2> columns = square(8);
+        WorldMemoryReport memory;
+        for (std::size_t i = 0, samples = scaled(options, 8); i < samples; i++) {
+            World world;
+            benchmark.time([&]() { generate(world, generator, jobs, columns); }, columns.size());
+            memory = world.memoryReport();
+        }
+        benchmark.metric("workers", jobs.workerCount());
+        // how compactly freshly generated terrain is stored, so palette changes show up here
+        benchmark.metric("world_sections", static_cast<double>(memory.sectionCount));
+        benchmark.metric("world_bytes", static_cast<double>(memory.totalBytes));
+        benchmark.metric("bytes_per_section", static_cast<double>(memory.bytesPerSection()));
+    }
+
+    // the same batch of small jobs with more and more workers
+    void jobScaling(Benchmark &benchmark, const BenchOptions &options) {
+        constexpr std::size_t JOBS = 4096;
+        Noise::FbmSettings settings{SEED, 4, 1.0f / 64.0f, 2.0f, 0.5f};
+        auto work = [&settings](std::size_t begin, std::size_t end) {
+            std::array<float, ChunkSection::AREA> out;
+            for (std::size_t i = begin; i < end; i++) {
+                Noise::fbm2D(settings, static_cast<int>(i) * ChunkSection::SIZE, 0, ChunkSection::SIZE,
+                    ChunkSection::SIZE, out.data());
+            }
+        };
+
+        std::vector<unsigned int> workerCounts;
+        for (unsigned int workers = 1; workers < options.workers; workers *= 2) {
+            workerCounts.push_back(workers);
+        }
+        workerCounts.push_back(options.workers);
+
+        std::size_t samples = scaled(options, 10);
+        // the same jobs run straight on this thread. parallelFor can't be the baseline: the caller runs
+        // jobs too while it waits, so even one worker is two threads.
+        Benchmark serial("", "");
+        for (std::size_t i = 0; i < samples; i++) {
+            serial.time([&]() { work(0, JOBS); }, JOBS);
+        }
+        double oneThread = serial.result().latency(50.0);
+        for (unsigned int workers : workerCounts) {
+            JobSystem jobs(workers);
+            // the benchmark's own samples are the ones with every worker
+            Benchmark run("", "");
+            Benchmark &target = workers == options.workers ? benchmark : run;
+            for (std::size_t i = 0; i < samples; i++) {
+                target.time([&]() { jobs.parallelFor(JOBS, 1, work); }, JOBS);
+            }
+            benchmark.metric("speedup_caller_plus_" + std::to_string(workers) + "_workers",
+                oneThread / target.result().latency(50.0));
+        }
+    }
+
+    void meshSections(Benchmark &benchmark, const BenchOptions &options) {
+        World world;
+        TerrainGenerator generator(SEED);
+        {
+            JobSystem jobs(options.workers);
+            generateLit(world, generator, jobs, 6);
+        }
+
+        Mesher mesher;
+        MeshData mesh;
+        std::size_t quads = 0;
+        std::size_t passes = scaled(options, 2);
+        for (std::size_t pass = 0; pass < passes; pass++) {
+            for (const auto &column : square(5)) {
+                for (int y = 0; y < World::COLUMN_SECTIONS; y++) {
+                    glm::ivec3 sectionPos(column.x, y, column.y);
+                    benchmark.time([&]() { mesher.mesh(world, sectionPos, mesh); });
+                    quads += mesh.quadCount();
+                }
+            }
+        }
+        benchmark.metric("quads_per_section", static_cast<double>(quads) / static_cast<double>(benchmark.result().operations));
+    }
+
+    void lightColumns(Benchmark &benchmark, const BenchOptions &options) {
+        TerrainGenerator generator(SEED);
+        JobSystem jobs(options.workers);
+        std::vector<glm::ivec2> batch = square(4);
+        std::size_t borderUpdates = 0;
+        for (std::size_t i = 0, samples = scaled(options, 5); i < samples; i++) {
+            World world;
+            generate(world, generator, jobs, square(5));
+            std::vector<LightEngine::BorderUpdate> outside;
+            benchmark.time([&]() { LightEngine::lightColumns(world, batch, {}, jobs, outside); }, batch.size());
+            borderUpdates = outside.size();
+        }
+        benchmark.metric("workers", jobs.workerCount());
+        benchmark.metric("border_updates", static_cast<double>(borderUpdates));
+    }
+
+    std::vector<Raycast::Ray> randomRays(std::size_t count, int radius) {
+        std::mt19937 random(SEED);
+        std::uniform_real_distribution<float> horizontal(static_cast<float>(-radius * ChunkSection::SIZE),
+            static_cast<float>(radius * ChunkSection::SIZE));
+        std::uniform_real_distribution<float> height(TerrainGenerator::SEA_LEVEL, TerrainGenerator::SEA_LEVEL + 40.0f);
+        std::normal_distribution<float> direction;
+        std::vector<Raycast::Ray> rays(count);
+        for (auto &ray : rays) {
+            glm::vec3 towards(direction(random), direction(random), direction(random));
+            ray = {{horizontal(random), height(random), horizontal(random)}, glm::normalize(towards), 64.0f};
+        }
+        return rays;
+    }
+
+    void raycast(Benchmark &benchmark, const BenchOptions &options) {
+        World world;
+        TerrainGenerator generator(SEED);
+        {
+            JobSystem jobs(options.workers);
+            generate(world, generator, jobs, square(5));
+        }
+        std::vector<Raycast::Ray> rays = randomRays(scaled(options, 4096) * Raycast::BATCH_SIZE, 4);
+
+        std::size_t hits = 0;
+        for (std::size_t begin = 0; begin < rays.size(); begin += Raycast::BATCH_SIZE) {
+            benchmark.time([&]() {
+                for (std::size_t i = begin; i < begin + Raycast::BATCH_SIZE; i++) {
+                    hits += Raycast::cast(world, rays[i]).hit ? 1 : 0;
+                }
+            }, Raycast::BATCH_SIZE);
+        }
+        benchmark.metric("hit_ratio", static_cast<double>(hits) / static_cast<double>(rays.size()));
+    }
+
+    void raycastParallel(Benchmark &benchmark, const BenchOptions &options) {
+        World world;
+        TerrainGenerator generator(SEED);
+        JobSystem jobs(options.workers);
+        generate(world, generator, jobs, square(5));
+        std::vector<Raycast::Ray> rays = randomRays(16384, 4);
+
+        std::vector<Raycast::Hit> hits;
+        for (std::size_t i = 0, samples = scaled(options, 32); i < samples; i++) {
+            benchmark.time([&]() { Raycast::castAll(world, rays, hits, jobs); }, rays.size());
+        }
+        benchmark.metric("workers", jobs.workerCount());
+    }
+
+    // breaks the top block of a random column or puts a torch on it, then relights and remeshes what that
+    // touched, like an edit in the game
+    void editBlocks(Benchmark &benchmark, const BenchOptions &options) {
+        constexpr int LIT_RADIUS = 4;
+        World world;
+        TerrainGenerator generator(SEED);
+        {
+            JobSystem jobs(options.workers);
+            generateLit(world, generator, jobs, LIT_RADIUS);
+        }
+
+        LightEngine light;
+        LightEngine::ColumnPredicate isLit = [](const glm::ivec2 &column) {
+            return column.x >= -LIT_RADIUS && column.x < LIT_RADIUS && column.y >= -LIT_RADIUS && column.y < LIT_RADIUS;
+        };
+        Mesher mesher;
+        MeshData mesh;
+        std::vector<glm::ivec3> changed;
+        std::vector<glm::ivec3> dirty;
+        std::size_t dirtySections = 0;
+
+        std::mt19937 random(SEED);
+        // a section's width inside the lit area, so edits never reach unlit columns
+        int edge = (LIT_RADIUS - 1) * ChunkSection::SIZE;
+        std::uniform_int_distribution<int> coordinate(-edge, edge - 1);
+        std::size_t edits = scaled(options, 256);
+        for (std::size_t i = 0; i < edits; i++) {
+            int x = coordinate(random);
+            int z = coordinate(random);
+            int y = surfaceHeight(world, x, z);
+            bool breaking = i % 2 == 0;
+            glm::ivec3 pos = breaking ? glm::ivec3(x, y, z) : glm::ivec3(x, y + 1, z);
+            benchmark.time([&]() {
+                world.setBlock(pos, breaking ? Blocks::AIR : Blocks::TORCH);
+                world.takeChangedBlocks(changed);
+                light.update(world, changed, isLit);
+                changed.clear();
+                world.takeDirtySections(dirty);
+                for (const auto &sectionPos : dirty) {
+                    mesher.mesh(world, sectionPos, mesh);
+                }
+            });
+            dirtySections += dirty.size();
+            dirty.clear();
+        }
+        benchmark.metric("dirty_sections_per_edit", static_cast<double>(dirtySections) / static_cast<double>(edits));
+    }
+
+    std::size_t directorySize(const fs::path &directory) {
+        std::size_t bytes = 0;
+        for (const auto &entry : fs::recursive_directory_iterator(directory)) {
+            if (entry.is_regular_file()) {
+                bytes += entry.file_size();
+            }
+        }
+        return bytes;
+    }
+
+    void regionSave(Benchmark &benchmark, const BenchOptions &options) {
+        World world;
+        TerrainGenerator generator(SEED);
+        std::vector<glm::ivec2> columns = square(8);
+        {
+            JobSystem jobs(options.workers);
+            generate(world, generator, jobs, columns);
+        }
+
+        fs::path directory = fs::path(options.scratchDirectory) / "region_save";
+        for (std::size_t i = 0, samples = scaled(options, 2); i < samples; i++) {
+            fs::remove_all(directory);
+            WorldStorage storage(directory.string());
+            for (const auto &column : columns) {
+                World::ColumnView view = world.getColumn(column.x, column.y);
+                benchmark.time([&]() { storage.saveColumn(column.x, column.y, view); });
+            }
+        }
+        benchmark.metric("bytes_per_column", static_cast<double>(directorySize(directory)) / static_cast<double>(columns.size()));
+        fs::remove_all(directory);
+    }
+
+    void regionLoad(Benchmark &benchmark, const BenchOptions &options) {
+        std::vector<glm::ivec2> columns = square(8);
+        fs::path directory = fs::path(options.scratchDirectory) / "region_load";
+        fs::remove_all(directory);
+        {
+            World world;
+            TerrainGenerator generator(SEED);
+            JobSystem jobs(options.workers);
+            generate(world, generator, jobs, columns);
+            WorldStorage storage(directory.string());
+            for (const auto &column : columns) {
+                storage.saveColumn(column.x, column.y, world.getColumn(column.x, column.y));
+            }
+        }
+
+        std::size_t missing = 0;
+        for (std::size_t i = 0, samples = scaled(options, 4); i < samples; i++) {
+            // a fresh storage maps the files again, like starting the game
+            WorldStorage storage(directory.string());
+            for (const auto &column : columns) {
+                World::Column loaded;
+                bool found = false;
+                benchmark.time([&]() { found = storage.loadColumn(column.x, column.y, loaded); });
+                missing += found ? 0 : 1;
+            }
+        }
+        benchmark.metric("missing_columns", static_cast<double>(missing));
+        fs::remove_all(directory);
+    }
+
+    // laid out like Game, so the workers are stopped before the streamer they call back into goes away
+    struct StreamingWorld {
+        World world;
+        TerrainGenerator generator{SEED};
+        WorldStorage storage;
+        ChunkStreamer streamer;
+        JobSystem jobs;
+
+        StreamingWorld(const std::string &saveDirectory, int viewDistance, unsigned int workers) :
+            storage(saveDirectory),
+            streamer(world, storage, generator, jobs, viewDistance),
+            jobs(workers) {}
+    };
+
+    // flies like the player at 60 ticks a second, turning now and then. a tick is what the game's update
+    // does for the streamer on the main thread.
+    void streamTicks(Benchmark &benchmark, const BenchOptions &options) {
+        constexpr float TICK_SECONDS = 1.0f / 60.0f;
+        constexpr int TURN_TICKS = 180;
+        constexpr std::size_t MESHES_PER_TICK = 256;
+
+        fs::path directory = fs::path(options.scratchDirectory) / "stream";
+        fs::remove_all(directory);
+        std::size_t meshes = 0;
+        std::size_t loadedColumns = 0;
+        std::size_t deferredUpdates = 0;
+        {
+            StreamingWorld streaming(directory.string(), 12, options.workers);
+            Camera camera(glm::vec3(0.0f, TerrainGenerator::SEA_LEVEL + 24.0f, 0.0f));
+            camera.movementSpeed = 40.0f;
+            std::vector<ChunkStreamer::FinishedMesh> finished;
+            std::vector<glm::ivec3> removed;
+
+            auto tickLength = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<float>(TICK_SECONDS));
+            auto nextTick = std::chrono::steady_clock::now();
+            for (std::size_t tick = 0, ticks = scaled(options, 600); tick < ticks; tick++) {
+                camera.move(1.0f, 0.0f, TICK_SECONDS);
+                if (tick % TURN_TICKS == TURN_TICKS - 1) {
+                    // a quarter turn to the right
+                    camera.turn(glm::vec2(90.0f / camera.mouseSensitivity, 0.0f));
+                }
+                benchmark.time([&]() {
+                    streaming.streamer.update(camera);
+                    streaming.streamer.takeRemovedSections(removed);
+                    removed.clear();
+                    streaming.streamer.takeMeshes(finished, MESHES_PER_TICK);
+                    for (auto &mesh : finished) {
+                        streaming.streamer.recycle(std::move(mesh.mesh));
+                    }
+                });
+                meshes += finished.size();
+                finished.clear();
+
+                // the workers get the rest of the tick, like they would between frames
+                nextTick += tickLength;
+                std::this_thread::sleep_until(nextTick);
+            }
+            loadedColumns = streaming.streamer.loadedColumnCount();
+            deferredUpdates = streaming.streamer.deferredUpdates();
+        }
+        // one slow tick is a dropped frame, so the worst one matters more than the percentiles
+        benchmark.metric("max_tick_ms", benchmark.result().latency(100.0) * 1000.0);
+        benchmark.metric("meshes", static_cast<double>(meshes));
+        benchmark.metric("loaded_columns", static_cast<double>(loadedColumns));
+        benchmark.metric("deferred_updates", static_cast<double>(deferredUpdates));
+        fs::remove_all(directory);
+    }
+}
+
+std::vector<Scenario> cpuScenarios() {
+    return {
+        {"section_set", "blocks", "random writes into a fresh 16^3 section", sectionSet},
+        {"section_get", "blocks", "random reads from a section of 8 block types", sectionGet},
+        {"noise_scalar", "samples", "3D fBm over one column with the scalar kernel", noiseScalar},
+        {"noise_sse41", "samples", "3D fBm over one column with the SSE4.1 kernel", noiseSse41},
+        {"noise_avx2", "samples", "3D fBm over one column with the AVX2 kernel", noiseAvx2},
+        {"noise_match", "grids", "2D and 3D fBm of odd sized grids, compared bit for bit against the scalar kernel",
+            noiseMatch},
+        {"generate", "columns", "terrain for one column on one thread", generateColumns},
+        {"generate_parallel", "columns", "terrain for 16x16 columns on the job system", generateParallel},
+        {"job_scaling", "jobs", "4096 small noise jobs on one thread, then through parallelFor with more workers",
+            jobScaling},
+        {"mesh", "sections", "greedy meshing of one generated, lit section", meshSections},
+        {"light", "columns", "lighting 8x8 fresh columns from scratch on the job system", lightColumns},
+        {"raycast", "rays", "random rays up to 64 blocks through generated terrain, on one thread", raycast},
+        {"raycast_parallel", "rays", "16384 random rays through castAll", raycastParallel},
+        {"edit", "edits", "a block edit with its relight and remesh", editBlocks},
+        {"region_save", "columns", "writing a generated column to a region file", regionSave},
+        {"region_load", "columns", "reading a saved column from a region file", regionLoad},
+        {"stream_ticks", "ticks", "the streamer's main thread work while flying at 40 blocks/s", streamTicks}
+    };
+}
@@ -0,0 +1,49 @@
+#include "Fixtures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "JobSystem.h"
+#include "LightEngine.h"
+#include "TerrainGenerator.h"
+#include "World.h"
+
+namespace Fixtures {
+    std::size_t scaled(const BenchOptions &options, std::size_t count) {
+        auto scaledCount = std::lround(static_cast<double>(count) * options.scale);
+        return std::max<std::size_t>(1, static_cast<std::size_t>(std::max(scaledCount, 0l)));
+    }
+
+    std::vector<glm::ivec2> square(int radius) {
+        std::vector<glm::ivec2> columns;
+        for (int x = -radius; x < radius; x++) {
+            for (int z = -radius; z < radius; z++) {
+                columns.emplace_back(x, z);
+            }
+        }
+        std::stable_sort(columns.begin(), columns.end(), [](const glm::ivec2 &a, const glm::ivec2 &b) {
+            return std::max(std::abs(a.x), std::abs(a.y)) < std::max(std::abs(b.x), std::abs(b.y));
+        });
+        return columns;
+    }
+
+    void generate(World &world, const TerrainGenerator &generator, JobSystem &jobs,
+        const std::vector<glm::ivec2> &columns) {
+        std::vector<World::Column> generated(columns.size());
+        jobs.parallelFor(columns.size(), 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                generated[i] = generator.generateColumn(columns[i].x, columns[i].y);
+            }
+        }, JobPriority::HIGH);
+        for (std::size_t i = 0; i < columns.size(); i++) {
+            world.setColumn(columns[i].x, columns[i].y, std::move(generated[i]));
+        }
+    }
+
+    void generateLit(World &world, const TerrainGenerator &generator, JobSystem &jobs, int radius) {
+        generate(world, generator, jobs, square(radius + 1));
+        std::vector<LightEngine::BorderUpdate> outside;
+        LightEngine::lightColumns(world, square(radius), {}, jobs, outside);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Scenarios.h"
+
+class JobSystem;
+class TerrainGenerator;
+class World;
+
+// Setup shared by the scenarios. None of it is timed.
+namespace Fixtures {
+    constexpr int SEED = 1337;
+
+    // count times the options' scale, at least 1
+    std::size_t scaled(const BenchOptions &options, std::size_t count);
+    // every column from -radius to radius - 1 on both axes, nearest first
+    std::vector<glm::ivec2> square(int radius);
+    void generate(World &world, const TerrainGenerator &generator, JobSystem &jobs,
+        const std::vector<glm::ivec2> &columns);
+    // generates radius + 1 and lights radius, since lighting needs every neighbour loaded
+    void generateLit(World &world, const TerrainGenerator &generator, JobSystem &jobs, int radius);
+}
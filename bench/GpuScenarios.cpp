@@ -0,0 +1,375 @@
+#include "Scenarios.h"
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+#ifdef BLOCKGAME_BENCH_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#include <glad/glad.h>
+
+#include "Block.h"
+#include "Camera.h"
+#include "ChunkRenderer.h"
+#include "Fixtures.h"
+#include "FrameUniforms.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
+#include "Mesher.h"
+#include "ProgramCache.h"
+#include "RenderQueue.h"
+#include "ResourceManager.h"
+#include "Shader.h"
+#include "TerrainGenerator.h"
+#include "World.h"
+
+namespace fs = std::filesystem;
+
+namespace Shaders {
+    extern const char *vertex;
+    extern const char *fragment;
+}
+
+namespace {
+    constexpr GLsizei WIDTH = 1280;
+    constexpr GLsizei HEIGHT = 720;
+    constexpr int UNIFORM_SETS = 10000;
+    // the same as the game's
+    constexpr std::size_t TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+#ifdef BLOCKGAME_BENCH_EGL
+    // a GL 3.3 core context with no surface at all. Mesa's surfaceless platform needs neither a display server
+    // nor a GPU (it falls back to llvmpipe), anything else goes through the default display.
+    class HeadlessContext {
+    private:
+        EGLDisplay _display{EGL_NO_DISPLAY};
+        EGLContext _context{EGL_NO_CONTEXT};
+
+    public:
+        HeadlessContext() {
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+            auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay) {
+                _display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+#endif
+            if (_display == EGL_NO_DISPLAY) {
+                _display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+            }
+            if (_display == EGL_NO_DISPLAY || !eglInitialize(_display, nullptr, nullptr)) {
+                throw std::runtime_error("Could not initialize EGL");
+            }
+            if (!eglBindAPI(EGL_OPENGL_API)) {
+                throw std::runtime_error("Could not bind OpenGL through EGL");
+            }
+
+            const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_NONE};
+            EGLConfig config;
+            EGLint configCount = 0;
+            if (!eglChooseConfig(_display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+                throw std::runtime_error("Could not find an EGL config for OpenGL");
+            }
+            const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+            _context = eglCreateContext(_display, config, EGL_NO_CONTEXT, contextAttributes);
+            if (_context == EGL_NO_CONTEXT) {
+                throw std::runtime_error("Could not create an OpenGL 3.3 core context through EGL");
+            }
+            // everything is drawn into framebuffer objects, so no surface is needed (EGL_KHR_surfaceless_context)
+            if (!eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, _context)) {
+                throw std::runtime_error("Could not make the EGL context current without a surface");
+            }
+
+            auto loader = reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+            if (!gladLoadGLLoader(loader)) {
+                throw std::runtime_error("Could not load OpenGL functions");
+            }
+            GLExtensions::init(loader);
+        }
+
+        ~HeadlessContext() {
+            eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(_display, _context);
+            eglTerminate(_display);
+        }
+
+        HeadlessContext(const HeadlessContext &other) = delete;
+        HeadlessContext &operator=(const HeadlessContext &other) = delete;
+    };
+#else
+    struct HeadlessContext {
+        HeadlessContext() {
+            throw std::runtime_error("BlockGameBench was built without EGL");
+        }
+    };
+#endif
+
+    // made by the first scenario that needs it, and kept for the rest
+    struct SharedContext {
+        bool tried{false};
+        std::unique_ptr<HeadlessContext> context{};
+        std::string error{};
+        std::string renderer{};
+    };
+
+    SharedContext &sharedContext() {
+        static SharedContext shared;
+        return shared;
+    }
+
+    // skips the scenario if there's no context
+    bool makeCurrent(Benchmark &benchmark) {
+        SharedContext &shared = sharedContext();
+        if (!shared.tried) {
+            shared.tried = true;
+            try {
+                shared.context = std::make_unique<HeadlessContext>();
+                shared.renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+            } catch (const std::exception &exception) {
+                shared.error = exception.what();
+            }
+        }
+        if (!shared.context) {
+            benchmark.skip(shared.error);
+            return false;
+        }
+        return true;
+    }
+
+    class Framebuffer {
+    private:
+        GLuint _framebuffer{0};
+        GLuint _color{0};
+        GLuint _depth{0};
+
+    public:
+        Framebuffer(GLsizei width, GLsizei height) {
+            glGenRenderbuffers(1, &_color);
+            glBindRenderbuffer(GL_RENDERBUFFER, _color);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+            glGenRenderbuffers(1, &_depth);
+            glBindRenderbuffer(GL_RENDERBUFFER, _depth);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+            glGenFramebuffers(1, &_framebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _color);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                throw std::runtime_error("Could not create the offscreen framebuffer");
+            }
+            GLState::viewport(0, 0, width, height);
+        }
+
+        ~Framebuffer() {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &_framebuffer);
+            glDeleteRenderbuffers(1, &_color);
+            glDeleteRenderbuffers(1, &_depth);
+        }
+
+        Framebuffer(const Framebuffer &other) = delete;
+        Framebuffer &operator=(const Framebuffer &other) = delete;
+    };
+
+    std::vector<std::string> blockTextureNames() {
+        std::vector<std::string> names;
+        for (std::uint16_t texture = 0; texture < BlockTextures::COUNT; texture++) {
+            names.emplace_back(BlockTextures::name(texture));
+        }
+        return names;
+    }
+
+    void loadBlockTextures(ResourceManager &resources, JobSystem &jobs) {
+        resources.loadTextureArray("blocks", "textures/blocks", blockTextureNames(), jobs);
+        while (!resources.uploadTextures(TEXTURE_UPLOAD_BUDGET)) {
+        }
+    }
+
+    void uniformSetCached(Benchmark &benchmark, const BenchOptions &options) {
+        if (!makeCurrent(benchmark)) {
+            return;
+        }
+        Shader shader(Shaders::vertex, Shaders::fragment);
+        shader.use();
+        for (std::size_t i = 0, samples = Fixtures::scaled(options, 100); i < samples; i++) {
+            benchmark.time([&]() {
+                for (int set = 0; set < UNIFORM_SETS; set++) {
+                    shader.set(Uniform::BLOCKS, set & 7);
+                }
+            }, UNIFORM_SETS);
+        }
+    }
+
+    // what every set cost before locations were looked up once at link time
+    void uniformSetLookup(Benchmark &benchmark, const BenchOptions &options) {
+        if (!makeCurrent(benchmark)) {
+            return;
+        }
+        Shader shader(Shaders::vertex, Shaders::fragment);
+        shader.use();
+        for (std::size_t i = 0, samples = Fixtures::scaled(options, 100); i < samples; i++) {
+            benchmark.time([&]() {
+                for (int set = 0; set < UNIFORM_SETS; set++) {
+                    glUniform1i(glGetUniformLocation(shader.id(), "blocks"), set & 7);
+                }
+            }, UNIFORM_SETS);
+        }
+    }
+
+    void shaderLink(Benchmark &benchmark, const BenchOptions &options, bool cached) {
+        if (!makeCurrent(benchmark)) {
+            return;
+        }
+        fs::path directory = fs::path(options.scratchDirectory) / "programs";
+        fs::remove_all(directory);
+        ProgramCache cache(directory.string());
+        if (cached) {
+            Shader warmUp(Shaders::vertex, Shaders::fragment, &cache);
+        }
+        for (std::size_t i = 0, samples = Fixtures::scaled(options, 20); i < samples; i++) {
+            if (!cached) {
+                fs::remove_all(directory);
+                fs::create_directories(directory);
+            }
+            benchmark.time([&]() {
+                Shader shader(Shaders::vertex, Shaders::fragment, &cache);
+                glFinish();
+            });
+        }
+        benchmark.metric("program_binaries_supported", cache.isSupported() ? 1.0 : 0.0);
+        fs::remove_all(directory);
+    }
+
+    void shaderLinkCold(Benchmark &benchmark, const BenchOptions &options) {
+        shaderLink(benchmark, options, false);
+    }
+
+    void shaderLinkCached(Benchmark &benchmark, const BenchOptions &options) {
+        shaderLink(benchmark, options, true);
+    }
+
+    // from asking for the block textures until the last layer is on the GPU, like the game's start
+    void textureColdStart(Benchmark &benchmark, const BenchOptions &options) {
+        if (!makeCurrent(benchmark)) {
+            return;
+        }
+        fs::path directory = fs::path(options.scratchDirectory) / "programs";
+        JobSystem jobs(options.workers);
+        ResourceManager::TextureLoadStats stats;
+        for (std::size_t i = 0, samples = Fixtures::scaled(options, 10); i < samples; i++) {
+            ResourceManager resources(options.resourceRoot, directory.string());
+            benchmark.time([&]() {
+                loadBlockTextures(resources, jobs);
+                glFinish();
+            });
+            stats = resources.textureLoadStats();
+        }
+        benchmark.metric("layers", static_cast<double>(stats.layers));
+        benchmark.metric("bytes", static_cast<double>(stats.bytes));
+        benchmark.metric("decode_ms", stats.decodeSeconds * 1000.0);
+        benchmark.metric("upload_ms", stats.uploadSeconds * 1000.0);
+        benchmark.metric("upload_calls", static_cast<double>(stats.uploadCalls));
+        fs::remove_all(directory);
+    }
+
+    // a full turn on the spot over 16x16 lit columns, drawn like the game draws a frame. a frame's time runs
+    // until the GPU is done with it.
+    void chunkRender(Benchmark &benchmark, const BenchOptions &options) {
+        constexpr int RADIUS = 8;
+        if (!makeCurrent(benchmark)) {
+            return;
+        }
+        Framebuffer target(WIDTH, HEIGHT);
+        GLState::setEnabled(GL_DEPTH_TEST, true);
+        glClearColor(0.3f, 0.3f, 0.3f, 1.0f);
+
+        World world;
+        TerrainGenerator generator(Fixtures::SEED);
+        JobSystem jobs(options.workers);
+        Fixtures::generateLit(world, generator, jobs, RADIUS);
+
+        fs::path directory = fs::path(options.scratchDirectory) / "programs";
+        ResourceManager resources(options.resourceRoot, directory.string());
+        const Shader &shader = resources.loadShader("chunk", "vertex", "fragment");
+        loadBlockTextures(resources, jobs);
+
+        ChunkRenderer renderer;
+        Mesher mesher;
+        MeshData mesh;
+        for (const auto &column : Fixtures::square(RADIUS)) {
+            for (int y = 0; y < World::COLUMN_SECTIONS; y++) {
+                glm::ivec3 sectionPos(column.x, y, column.y);
+                mesher.mesh(world, sectionPos, mesh);
+                renderer.upload(sectionPos, mesh);
+            }
+        }
+
+        FrameUniforms frameUniforms;
+        RenderQueue queue(jobs.workerCount());
+        GpuTimer timer;
+        Camera camera(glm::vec3(0.0f, TerrainGenerator::SEA_LEVEL + 24.0f, 0.0f));
+        camera.aspectRatio = static_cast<float>(WIDTH) / static_cast<float>(HEIGHT);
+        float fogEnd = RADIUS * ChunkSection::SIZE;
+        camera.farPlane = fogEnd * 1.5f;
+
+        std::size_t frames = Fixtures::scaled(options, 360);
+        std::map<std::string, double> gpuMilliseconds;
+        std::size_t gpuFrames = 0;
+        std::size_t visible = 0;
+        for (std::size_t frame = 0; frame < frames; frame++) {
+            camera.turn(glm::vec2(360.0f / static_cast<float>(frames) / camera.mouseSensitivity, 0.0f));
+            benchmark.time([&]() {
+                timer.beginFrame();
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                frameUniforms.update(camera, static_cast<float>(frame) / 60.0f,
+                    {glm::vec3(0.3f, 0.3f, 0.3f), fogEnd * 0.6f, fogEnd});
+                resources.getTextureArray("blocks").bind(Shaders::textureUnit(Uniform::BLOCKS));
+                renderer.submit(queue, shader, camera, jobs);
+                queue.sort();
+                queue.execute(&timer);
+                timer.endFrame();
+                glFinish();
+            });
+            visible += renderer.visibleCount();
+            if (!timer.results().empty()) {
+                for (const auto &result : timer.results()) {
+                    gpuMilliseconds[result.name] += result.milliseconds;
+                }
+                gpuFrames++;
+            }
+        }
+
+        benchmark.metric("sections", static_cast<double>(renderer.meshCount()));
+        benchmark.metric("visible_sections", static_cast<double>(visible) / static_cast<double>(frames));
+        benchmark.metric("draw_calls", static_cast<double>(renderer.drawCallCount()));
+        for (const auto &[name, milliseconds] : gpuMilliseconds) {
+            benchmark.metric("gpu_" + name + "_ms", milliseconds / static_cast<double>(std::max<std::size_t>(gpuFrames, 1)));
+        }
+        fs::remove_all(directory);
+    }
+}
+
+std::vector<Scenario> gpuScenarios() {
+    return {
+        {"uniform_set", "sets", "10k sets of a uniform through its location resolved at link time", uniformSetCached},
+        {"uniform_set_lookup", "sets", "10k sets of a uniform, looking up its location every time", uniformSetLookup},
+        {"shader_link_cold", "programs", "compiling and linking the chunk shader with an empty program cache",
+            shaderLinkCold},
+        {"shader_link_cached", "programs", "loading the chunk shader from the program cache", shaderLinkCached},
+        {"texture_cold_start", "loads", "decoding and uploading every block texture", textureColdStart},
+        {"chunk_render", "frames", "drawing 16x16 lit columns into a 1280x720 framebuffer, until the GPU is done",
+            chunkRender}
+    };
+}
+
+std::string gpuRenderer() {
+    return sharedContext().renderer;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+struct BenchOptions {
+    // multiplies how much work every scenario does, for quick checks or steadier numbers
+    double scale{1.0};
+    unsigned int workers{0};
+    // for the scenarios that load resources, relative to the working directory like the game's
+    std::string resourceRoot{"resources"};
+    // scratch space for save files and caches, emptied afterwards
+    std::string scratchDirectory{};
+};
+
+// A fixed piece of work with a fixed seed, so two runs on the same machine do the same thing.
+struct Scenario {
+    const char *name;
+    const char *unit;
+    const char *description;
+    void (*run)(Benchmark &benchmark, const BenchOptions &options);
+};
+
+std::vector<Scenario> cpuScenarios();
+// these make their own GL context through EGL, and skip themselves if there's none
+std::vector<Scenario> gpuScenarios();
+// the GL_RENDERER of the benchmark context, empty if none was made
+std::string gpuRenderer();
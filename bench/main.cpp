@@ -0,0 +1,138 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "Memory.h"
+#include "Noise.h"
+#include "Profiler.h"
+#include "Scenarios.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    void printUsage() {
+        std::cerr << "usage: BlockGameBench [--filter <text>] [--output <file>] [--scale <factor>] "
+                     "[--workers <count>] [--resources <directory>] [--list]\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    Profiler::setThreadName("main");
+
+    BenchOptions options;
+    options.workers = JobSystem::defaultWorkerCount();
+    std::string filter;
+    std::string output;
+    bool list = false;
+    try {
+        for (int i = 1; i < argc; i++) {
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+                filter = argv[++i];
+            } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+                output = argv[++i];
+            } else if (std::strcmp(argv[i], "--scale") == 0 && hasValue) {
+                options.scale = std::stod(argv[++i]);
+            } else if (std::strcmp(argv[i], "--workers") == 0 && hasValue) {
+                options.workers = static_cast<unsigned int>(std::stoul(argv[++i]));
+                // the job system needs at least one worker
+                if (options.workers == 0) {
+                    printUsage();
+                    return 1;
+                }
+            } else if (std::strcmp(argv[i], "--resources") == 0 && hasValue) {
+                options.resourceRoot = argv[++i];
+            } else if (std::strcmp(argv[i], "--list") == 0) {
+                list = true;
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &exception) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Scenario> scenarios = cpuScenarios();
+    for (const Scenario &scenario : gpuScenarios()) {
+        scenarios.push_back(scenario);
+    }
+    if (list) {
+        for (const Scenario &scenario : scenarios) {
+            std::cout << scenario.name << ": " << scenario.description << "\n";
+        }
+        return 0;
+    }
+
+    options.scratchDirectory = (fs::temp_directory_path() / "blockgame-bench").string();
+    fs::remove_all(options.scratchDirectory);
+    fs::create_directories(options.scratchDirectory);
+
+    std::vector<Benchmark::Result> results;
+    for (const Scenario &scenario : scenarios) {
+        if (!filter.empty() && std::strstr(scenario.name, filter.c_str()) == nullptr) {
+            continue;
+        }
+        std::cerr << scenario.name << "..." << std::endl;
+        Benchmark benchmark(scenario.name, scenario.unit);
+        BenchmarkReport::resetPeakRss();
+        Memory::resetPeaks();
+        try {
+            scenario.run(benchmark, options);
+        } catch (const std::exception &exception) {
+            benchmark.fail(exception.what());
+            std::cerr << "  failed: " << exception.what() << std::endl;
+        }
+        benchmark.setPeakRss(BenchmarkReport::peakRss());
+        // the high-water mark of every tag the scenario used, to catch a subsystem growing
+        MemoryReport memory = Memory::report();
+        for (std::size_t domain = 0; domain < MEMORY_DOMAIN_COUNT; domain++) {
+            for (std::size_t tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+                std::size_t peak = memory.usage[domain][tag].peakBytes;
+                if (peak > 0) {
+                    benchmark.metric(std::string("peak_") + MEMORY_DOMAIN_NAMES[domain] + "_" + MEMORY_TAG_NAMES[tag]
+                        + "_bytes", static_cast<double>(peak));
+                }
+            }
+        }
+        if (!benchmark.result().skipped.empty()) {
+            std::cerr << "  skipped: " << benchmark.result().skipped << std::endl;
+        }
+        results.push_back(benchmark.result());
+    }
+    fs::remove_all(options.scratchDirectory);
+
+    std::ostringstream scale;
+    scale << options.scale;
+    std::vector<std::pair<std::string, std::string>> info = {
+        {"benchmark", "BlockGameBench"},
+        {"scale", scale.str()},
+        {"workers", std::to_string(options.workers)},
+        {"noise_isa", Noise::isaName(Noise::bestIsa())},
+        {"gpu_renderer", gpuRenderer()}
+    };
+    if (output.empty()) {
+        BenchmarkReport::writeJson(std::cout, info, results);
+    } else {
+        std::ofstream file(output);
+        BenchmarkReport::writeJson(file, info, results);
+        if (!file) {
+            std::cerr << "Could not write '" << output << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    for (const Benchmark::Result &result : results) {
+        if (!result.error.empty()) {
+            return 1;
+        }
+    }
+    return 0;
+}
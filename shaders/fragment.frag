@@ -1,12 +1,32 @@
 #version 330 core
 
 in vec2 TexCoord;
+flat in uint Layer;
+in float Brightness;
+in float Fog;
 
 out vec4 FragColor;
 
-uniform sampler2D texture1;
-uniform sampler2D texture2;
+// every block texture, indexed by BlockTextures
+uniform sampler2DArray blocks;
+
+// per-frame data shared by every program, see FrameUniforms.h
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    // w is the time in seconds
+    vec4 cameraPosition;
+    vec4 fogColor;
+    // x is where fog starts, y where it hides everything
+    vec4 fogRange;
+};
 
 void main() {
-    FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+    vec4 color = texture(blocks, vec3(TexCoord, float(Layer)));
+    // leaves and torches are cut out of their textures
+    if (color.a < 0.5) {
+        discard;
+    }
+    FragColor = vec4(mix(color.rgb * Brightness, fogColor.rgb, Fog), color.a);
 }
@@ -1,15 +1,48 @@
 #version 330 core
 
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
+// a packed BlockVertex, see BlockVertex.h. the BLOCK_VERTEX_ constants are added by GenerateShaders.py.
+layout (location = 0) in uvec2 aVertex;
 
 out vec2 TexCoord;
+// layer of the block texture array
+flat out uint Layer;
+out float Brightness;
+out float Fog;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// per-frame data shared by every program, see FrameUniforms.h
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    // w is the time in seconds
+    vec4 cameraPosition;
+    vec4 fogColor;
+    // x is where fog starts, y where it hides everything
+    vec4 fogRange;
+};
+
+// the origin of the section using each slot of the vertex buffer
+uniform isamplerBuffer origins;
+
+// same as ChunkRenderer::VERTICES_PER_SLOT
+const int VERTICES_PER_SLOT = 256;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    TexCoord = aTexCoord;
+    vec3 position = vec3((aVertex.x >> BLOCK_VERTEX_X_SHIFT) & BLOCK_VERTEX_X_MASK,
+        (aVertex.x >> BLOCK_VERTEX_Y_SHIFT) & BLOCK_VERTEX_Y_MASK, (aVertex.x >> BLOCK_VERTEX_Z_SHIFT) & BLOCK_VERTEX_Z_MASK);
+    uint axis = ((aVertex.x >> BLOCK_VERTEX_FACE_SHIFT) & BLOCK_VERTEX_FACE_MASK) / 2u;
+    uint light = (aVertex.y >> BLOCK_VERTEX_LIGHT_SHIFT) & BLOCK_VERTEX_LIGHT_MASK;
+
+    // gl_VertexID includes the draw's base vertex, so it counts from the start of the whole buffer
+    vec3 origin = vec3(texelFetch(origins, gl_VertexID / VERTICES_PER_SLOT).xyz);
+    vec3 worldPosition = position + origin;
+    gl_Position = viewProjection * vec4(worldPosition, 1.0);
+    // textures stay upright on the sides, and line up across neighbouring quads
+    TexCoord = axis == 0u ? position.zy : axis == 1u ? position.xz : position.xy;
+    Layer = (aVertex.y >> BLOCK_VERTEX_TEXTURE_SHIFT) & BLOCK_VERTEX_TEXTURE_MASK;
+    // sky light in the high nibble, block light in the low one. each level is a bit darker than the last,
+    // and nothing goes completely black.
+    float level = float(max(light >> 4u, light & 15u));
+    Brightness = max(pow(0.8, 15.0 - level), 0.05);
+    Fog = clamp((distance(worldPosition, cameraPosition.xyz) - fogRange.x) / (fogRange.y - fogRange.x), 0.0, 1.0);
 }
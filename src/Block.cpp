@@ -0,0 +1,27 @@
+#include "Block.h"
+
+namespace T = BlockTextures;
+using P = RenderPass;
+
+// faces are in BlockFace order: -x, +x, -y, +y, -z, +z
+const BlockInfo Blocks::infos[Blocks::COUNT] = {
+    {"air", false, {0, 0, 0, 0, 0, 0}, 0, P::OPAQUE},
+    {"stone", true, {T::STONE, T::STONE, T::STONE, T::STONE, T::STONE, T::STONE}, 0, P::OPAQUE},
+    {"dirt", true, {T::DIRT, T::DIRT, T::DIRT, T::DIRT, T::DIRT, T::DIRT}, 0, P::OPAQUE},
+    {"grass", true, {T::GRASS_SIDE, T::GRASS_SIDE, T::DIRT, T::GRASS_TOP, T::GRASS_SIDE, T::GRASS_SIDE}, 0, P::OPAQUE},
+    {"sand", true, {T::SAND, T::SAND, T::SAND, T::SAND, T::SAND, T::SAND}, 0, P::OPAQUE},
+    {"water", false, {T::WATER, T::WATER, T::WATER, T::WATER, T::WATER, T::WATER}, 0, P::TRANSLUCENT},
+    {"log", true, {T::LOG_SIDE, T::LOG_SIDE, T::LOG_TOP, T::LOG_TOP, T::LOG_SIDE, T::LOG_SIDE}, 0, P::OPAQUE},
+    {"leaves", false, {T::LEAVES, T::LEAVES, T::LEAVES, T::LEAVES, T::LEAVES, T::LEAVES}, 0, P::CUTOUT},
+    {"torch", false, {T::TORCH, T::TORCH, T::TORCH, T::TORCH, T::TORCH, T::TORCH}, 14, P::CUTOUT},
+};
+
+namespace {
+    const char *textureNames[BlockTextures::COUNT] = {
+        "stone", "dirt", "grass_top", "grass_side", "sand", "water", "log_top", "log_side", "leaves", "torch"
+    };
+}
+
+const char *BlockTextures::name(std::uint16_t texture) {
+    return texture < COUNT ? textureNames[texture] : "missing";
+}
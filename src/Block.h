@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+#include "RenderPass.h"
+
+using BlockId = std::uint16_t;
+
+enum class BlockFace : std::uint8_t {
+    NEG_X,
+    POS_X,
+    NEG_Y,
+    POS_Y,
+    NEG_Z,
+    POS_Z
+};
+
+struct BlockInfo {
+    const char *name;
+    // opaque blocks hide the faces of whatever is next to them
+    bool opaque;
+    // texture for each face, indexed by BlockFace
+    std::uint16_t textures[6];
+    // block light level the block gives off, 0 to 15
+    std::uint8_t lightEmission;
+    // the pass the block's faces are drawn in
+    RenderPass pass;
+};
+
+namespace Blocks {
+    constexpr BlockId AIR = 0;
+    constexpr BlockId STONE = 1;
+    constexpr BlockId DIRT = 2;
+    constexpr BlockId GRASS = 3;
+    constexpr BlockId SAND = 4;
+    constexpr BlockId WATER = 5;
+    constexpr BlockId LOG = 6;
+    constexpr BlockId LEAVES = 7;
+    constexpr BlockId TORCH = 8;
+    constexpr BlockId COUNT = 9;
+
+    extern const BlockInfo infos[COUNT];
+
+    // unknown ids are treated like air
+    inline const BlockInfo &info(BlockId block) {
+        return infos[block < COUNT ? block : AIR];
+    }
+}
+
+namespace BlockTextures {
+    constexpr std::uint16_t STONE = 0;
+    constexpr std::uint16_t DIRT = 1;
+    constexpr std::uint16_t GRASS_TOP = 2;
+    constexpr std::uint16_t GRASS_SIDE = 3;
+    constexpr std::uint16_t SAND = 4;
+    constexpr std::uint16_t WATER = 5;
+    constexpr std::uint16_t LOG_TOP = 6;
+    constexpr std::uint16_t LOG_SIDE = 7;
+    constexpr std::uint16_t LEAVES = 8;
+    constexpr std::uint16_t TORCH = 9;
+    constexpr std::uint16_t COUNT = 10;
+
+    // the texture's file name (without extension) under resources/textures/blocks
+    const char *name(std::uint16_t texture);
+}
@@ -0,0 +1,87 @@
+#include "BlockVertex.h"
+
+namespace {
+    // reads a field straight out of a packed word, one bit at a time. the bit positions passed in are the
+    // documented layout written out by hand, not BlockVertexLayout.h, so a wrong shift or mask shows up.
+    constexpr int bits(std::uint32_t word, int first, int count) {
+        int value = 0;
+        for (int bit = 0; bit < count; bit++) {
+            if (word >> (first + bit) & 1u) {
+                value |= 1 << bit;
+            }
+        }
+        return value;
+    }
+
+    // position: x in bits 0-4, y in 5-9, z in 10-14 and face in 15-17, nothing above
+    constexpr bool positionRoundTrips(int x, int y, int z, BlockFace face) {
+        BlockVertex packed = BlockVertex::pack({x, y, z, face, 0, 0, 0, 0});
+        if (bits(packed.position, 0, 5) != x || bits(packed.position, 5, 5) != y
+            || bits(packed.position, 10, 5) != z || bits(packed.position, 15, 3) != static_cast<int>(face)
+            || packed.position >> 18 != 0 || packed.material != 0) {
+            return false;
+        }
+
+        // the axes the texture runs along on each face
+        int u = 0;
+        int v = 0;
+        switch (face) {
+            case BlockFace::NEG_X: case BlockFace::POS_X: u = z; v = y; break;
+            case BlockFace::NEG_Y: case BlockFace::POS_Y: u = x; v = z; break;
+            case BlockFace::NEG_Z: case BlockFace::POS_Z: u = x; v = y; break;
+        }
+        BlockVertex::Unpacked vertex = packed.unpack();
+        return vertex.x == x && vertex.y == y && vertex.z == z && vertex.face == face && vertex.texture == 0
+            && vertex.light == 0 && vertex.u == u && vertex.v == v;
+    }
+
+    // material: texture in bits 0-15 and light in 16-23, nothing above. the position is the far corner, so
+    // material bits leaking into it show up too.
+    constexpr bool materialRoundTrips(std::uint16_t texture, std::uint8_t light) {
+        BlockVertex packed = BlockVertex::pack({16, 16, 16, BlockFace::POS_Z, texture, light, 0, 0});
+        if (bits(packed.material, 0, 16) != texture || bits(packed.material, 16, 8) != light
+            || packed.material >> 24 != 0) {
+            return false;
+        }
+        BlockVertex::Unpacked vertex = packed.unpack();
+        return vertex.x == 16 && vertex.y == 16 && vertex.z == 16 && vertex.face == BlockFace::POS_Z
+            && vertex.texture == texture && vertex.light == light;
+    }
+
+    // every corner of every block in a section
+    constexpr bool everyPositionRoundTrips(BlockFace face) {
+        for (int y = 0; y <= 16; y++) {
+            for (int z = 0; z <= 16; z++) {
+                for (int x = 0; x <= 16; x++) {
+                    if (!positionRoundTrips(x, y, z, face)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // every light value, with the first and last real textures and the highest layer that fits
+    constexpr bool everyMaterialRoundTrips() {
+        constexpr std::uint16_t textures[] = {0, 1, BlockTextures::COUNT - 1, 0x5A5A, 0xFFFF};
+        for (int light = 0; light <= 255; light++) {
+            for (std::uint16_t texture : textures) {
+                if (!materialRoundTrips(texture, static_cast<std::uint8_t>(light))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+// checked once here rather than in every file including the header, since it takes a while to compile. one
+// assert per face keeps each evaluation to a few million steps, under GCC's default constexpr limit.
+static_assert(everyPositionRoundTrips(BlockFace::NEG_X), "packing a block vertex loses its position");
+static_assert(everyPositionRoundTrips(BlockFace::POS_X), "packing a block vertex loses its position");
+static_assert(everyPositionRoundTrips(BlockFace::NEG_Y), "packing a block vertex loses its position");
+static_assert(everyPositionRoundTrips(BlockFace::POS_Y), "packing a block vertex loses its position");
+static_assert(everyPositionRoundTrips(BlockFace::NEG_Z), "packing a block vertex loses its position");
+static_assert(everyPositionRoundTrips(BlockFace::POS_Z), "packing a block vertex loses its position");
+static_assert(everyMaterialRoundTrips(), "packing a block vertex loses its texture or light");
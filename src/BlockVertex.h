@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Block.h"
+#include "BlockVertexLayout.h"
+
+// One block geometry vertex packed into 8 bytes, decoded again by the chunk vertex shader.
+//
+// Positions are whole blocks relative to the section's minimum corner, so 5 bits an axis cover 0 to 16.
+// Texture coordinates are in blocks too and always equal two of the position's axes (which two depends on
+// the face), so they aren't stored at all.
+//
+// Fields are packed into two words: x, y, z and face into position, texture and light into material. Their
+// bits come from blockVertexLayout in GenerateShaders.py, which generates BlockVertexLayout.h and the vertex
+// shader's constants from the same table.
+struct BlockVertex {
+    std::uint32_t position;
+    std::uint32_t material;
+
+    // the same vertex with every field spelled out, for building and checking packed ones
+    struct Unpacked {
+        int x;
+        int y;
+        int z;
+        BlockFace face;
+        std::uint16_t texture;
+        // see Light.h
+        std::uint8_t light;
+        int u;
+        int v;
+    };
+
+    // u and v are ignored, they follow from the position and face
+    static constexpr BlockVertex pack(const Unpacked &vertex) {
+        using namespace BlockVertexLayout;
+        return {
+            field(vertex.x, X_SHIFT, X_MASK) | field(vertex.y, Y_SHIFT, Y_MASK) | field(vertex.z, Z_SHIFT, Z_MASK)
+                | field(static_cast<int>(vertex.face), FACE_SHIFT, FACE_MASK),
+            field(vertex.texture, TEXTURE_SHIFT, TEXTURE_MASK) | field(vertex.light, LIGHT_SHIFT, LIGHT_MASK)
+        };
+    }
+
+    constexpr Unpacked unpack() const {
+        using namespace BlockVertexLayout;
+        int x = static_cast<int>(position >> X_SHIFT & X_MASK);
+        int y = static_cast<int>(position >> Y_SHIFT & Y_MASK);
+        int z = static_cast<int>(position >> Z_SHIFT & Z_MASK);
+        auto face = static_cast<BlockFace>(position >> FACE_SHIFT & FACE_MASK);
+        // textures stay upright on the sides, and line up across neighbouring quads
+        int axis = static_cast<int>(face) / 2;
+        int u = axis == 0 ? z : x;
+        int v = axis == 1 ? z : y;
+        return {x, y, z, face, static_cast<std::uint16_t>(material >> TEXTURE_SHIFT & TEXTURE_MASK),
+            static_cast<std::uint8_t>(material >> LIGHT_SHIFT & LIGHT_MASK), u, v};
+    }
+
+private:
+    static constexpr std::uint32_t field(int value, std::uint32_t shift, std::uint32_t mask) {
+        return (static_cast<std::uint32_t>(value) & mask) << shift;
+    }
+};
+
+static_assert(sizeof(BlockVertex) == 8, "block vertices are two 32 bit integer attributes");
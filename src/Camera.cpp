@@ -1,8 +1,5 @@
 #include "Camera.h"
 
-#include <GLFW/glfw3.h>
-#include "Input.h"
-
 Camera::Camera(glm::vec3 _position, glm::vec3 _up, float pitch, float yaw) :
     position(std::move(_position)),
     front(glm::vec3(0.0f, 0.0f, -1.0f)),
@@ -11,7 +8,11 @@ Camera::Camera(glm::vec3 _position, glm::vec3 _up, float pitch, float yaw) :
     pitch(pitch),
     yaw(yaw),
     movementSpeed(2.5f),
-    mouseSensitivity(0.1f) {
+    mouseSensitivity(0.1f),
+    fov(70.0f),
+    aspectRatio(4.0f / 3.0f),
+    nearPlane(0.1f),
+    farPlane(1000.0f) {
     updateCameraVectors();
 }
 
@@ -19,25 +20,24 @@ glm::mat4 Camera::viewMatrix() const {
     return glm::lookAt(position, position + front, up);
 }
 
-void Camera::processInput(const Input &input, float deltaTime) {
+glm::mat4 Camera::projectionMatrix() const {
+    return glm::perspective(glm::radians(fov), aspectRatio, nearPlane, farPlane);
+}
+
+Frustum Camera::frustum() const {
+    return Frustum(projectionMatrix() * viewMatrix());
+}
+
+void Camera::move(float forward, float sideways, float deltaTime) {
     float velocity = movementSpeed * deltaTime;
-    if (input.isKeyPressed(GLFW_KEY_W)) {
-        position += front * velocity;
-    }
-    if (input.isKeyPressed(GLFW_KEY_S)) {
-        position -= front * velocity;
-    }
-    if (input.isKeyPressed(GLFW_KEY_A)) {
-        position -= right * velocity;
-    }
-    if (input.isKeyPressed(GLFW_KEY_S)) {
-        position += right * velocity;
-    }
+    position += front * (forward * velocity);
+    position += right * (sideways * velocity);
+}
 
-    glm::vec2 mouseOffset = input.mouseOffset();
-    mouseOffset *= mouseSensitivity;
-    pitch += mouseOffset.y;
-    yaw += mouseOffset.x;
+void Camera::turn(glm::vec2 offset) {
+    offset *= mouseSensitivity;
+    pitch += offset.y;
+    yaw += offset.x;
 
     // constrain the pitch so the screen doesnt get flipped
     if (pitch > 89.0f) {
@@ -53,7 +53,7 @@ void Camera::processInput(const Input &input, float deltaTime) {
 // calculates the front vector from the Camera's (updated) Euler Angles
 void Camera::updateCameraVectors() {
     // calculate the new front vector
-    front.x = cos(glm::radians(pitch) * cos(glm::radians(yaw)));
+    front.x = cos(glm::radians(pitch)) * cos(glm::radians(yaw));
     front.y = sin(glm::radians(pitch));
     front.z = cos(glm::radians(pitch)) * sin(glm::radians(yaw));
     front = glm::normalize(front);
@@ -4,8 +4,9 @@
 
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec2.hpp>
 
-class Input;
+#include "Frustum.h"
 
 struct Camera {
 public:
@@ -21,6 +22,12 @@ public:
     float movementSpeed;
     float mouseSensitivity;
 
+    // vertical field of view, in degrees
+    float fov;
+    float aspectRatio;
+    float nearPlane;
+    float farPlane;
+
 public:
     Camera(
         glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f),
@@ -28,8 +35,14 @@ public:
         float pitch = 0.0f, float yaw = -90.0f);
 
     glm::mat4 viewMatrix() const;
-
-    void processInput(const Input &input, float deltaTime);
+    glm::mat4 projectionMatrix() const;
+    // the volume visible through this camera, for culling
+    Frustum frustum() const;
+
+    // forward and sideways are -1 to 1, scaled by movementSpeed. positive sideways is to the right.
+    void move(float forward, float sideways, float deltaTime);
+    // offset is in mouse movement, scaled by mouseSensitivity
+    void turn(glm::vec2 offset);
 
 private:
     void updateCameraVectors();
@@ -0,0 +1,408 @@
+#include "ChunkRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+
+#include <glm/common.hpp>
+
+#include "Camera.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "JobSystem.h"
+#include "Shader.h"
+
+namespace {
+    // a section can't produce more quads than a 3D checkerboard does: every face of half its blocks
+    constexpr std::size_t MAX_QUADS = ChunkSection::VOLUME / 2 * 6;
+
+    // glad is generated for plain 3.3, so indirect drawing is loaded by hand
+    constexpr GLenum DRAW_INDIRECT_BUFFER = 0x8F3F;
+    typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect,
+        GLsizei drawCount, GLsizei stride);
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+
+    MultiDrawElementsIndirectProc loadMultiDrawElementsIndirect() {
+        if (!GLExtensions::isSupported("GL_ARB_multi_draw_indirect")) {
+            return nullptr;
+        }
+        return reinterpret_cast<MultiDrawElementsIndirectProc>(
+            GLExtensions::procAddress("glMultiDrawElementsIndirect"));
+    }
+
+    std::size_t vertexOffset(std::uint32_t slot) {
+        return static_cast<std::size_t>(slot) * ChunkRenderer::VERTICES_PER_SLOT * sizeof(BlockVertex);
+    }
+
+    std::size_t originOffset(std::uint32_t slot) {
+        return static_cast<std::size_t>(slot) * sizeof(glm::ivec4);
+    }
+
+    void setVertexAttributes(unsigned int vertexBuffer) {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        // both halves of the packed vertex as one uvec2, decoded by the vertex shader
+        glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(BlockVertex), nullptr);
+        glEnableVertexAttribArray(0);
+    }
+
+    // a buffer of size bytes with nothing in it yet, for glCopyBufferSubData to fill
+    unsigned int createBuffer(std::size_t size) {
+        unsigned int buffer;
+        glGenBuffers(1, &buffer);
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STATIC_DRAW);
+        return buffer;
+    }
+}
+
+ChunkRenderer::ChunkRenderer() {
+    std::vector<std::uint32_t> indices;
+    indices.reserve(MAX_QUADS * 6);
+    for (std::uint32_t quad = 0; quad < MAX_QUADS; quad++) {
+        std::uint32_t first = quad * 4;
+        for (std::uint32_t offset : {0u, 1u, 2u, 2u, 3u, 0u}) {
+            indices.push_back(first + offset);
+        }
+    }
+    glGenBuffers(1, &_indexBuffer);
+    // the index buffer binding is part of the vertex array, so this must not go into one of the pages
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint32_t), indices.data(), GL_STATIC_DRAW);
+    _geometryMemory.resize(indices.size() * sizeof(std::uint32_t));
+
+    multiDrawElementsIndirect = loadMultiDrawElementsIndirect();
+    if (multiDrawElementsIndirect) {
+        glGenBuffers(1, &_indirectBuffer);
+    }
+    createPage();
+}
+
+ChunkRenderer::~ChunkRenderer() {
+    for (auto &page : _pages) {
+        GLState::deleteVertexArrays(1, &page.vao);
+        GLState::deleteTextures(1, &page.originTexture);
+        GLState::deleteBuffers(1, &page.vertexBuffer);
+        GLState::deleteBuffers(1, &page.originBuffer);
+    }
+    if (_indirectBuffer) {
+        GLState::deleteBuffers(1, &_indirectBuffer);
+    }
+    GLState::deleteBuffers(1, &_indexBuffer);
+}
+
+void ChunkRenderer::upload(const glm::ivec3 &sectionPos, const MeshData &mesh) {
+    if (mesh.isEmpty()) {
+        remove(sectionPos);
+        return;
+    }
+    if (mesh.quadCount() > MAX_QUADS) {
+        throw std::runtime_error("Could not upload section mesh: too many quads");
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    glm::ivec3 min(ChunkSection::SIZE);
+    glm::ivec3 max(0);
+    for (const auto &vertex : mesh.vertices) {
+        BlockVertex::Unpacked unpacked = vertex.unpack();
+        min = glm::min(min, glm::ivec3(unpacked.x, unpacked.y, unpacked.z));
+        max = glm::max(max, glm::ivec3(unpacked.x, unpacked.y, unpacked.z));
+    }
+    glm::ivec3 origin = sectionPos * ChunkSection::SIZE;
+
+    auto [iterator, inserted] = _meshes.try_emplace(sectionPos);
+    SectionMesh &sectionMesh = iterator->second;
+    if (inserted) {
+        sectionMesh.boxIndex = _positions.size();
+        _positions.push_back(sectionPos);
+        _boxes.add(glm::vec3(origin + min), glm::vec3(origin + max));
+    } else {
+        _boxes.set(sectionMesh.boxIndex, glm::vec3(origin + min), glm::vec3(origin + max));
+    }
+
+    // a mesh that still needs as many slots stays where it is. the GPU finishes drawing the old vertices
+    // before the copy replacing them runs.
+    auto slotCount = static_cast<std::uint32_t>((mesh.vertices.size() + VERTICES_PER_SLOT - 1) / VERTICES_PER_SLOT);
+    if (sectionMesh.slotCount != slotCount) {
+        freeSlots(sectionMesh);
+        allocateSlots(sectionMesh, slotCount);
+    }
+    _vertexBytes -= sectionMesh.vertexCount * sizeof(BlockVertex);
+    sectionMesh.vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+    sectionMesh.passVertexCounts = mesh.passVertexCounts;
+    _vertexBytes += sectionMesh.vertexCount * sizeof(BlockVertex);
+
+    const Page &page = _pages[sectionMesh.page];
+    std::size_t size = mesh.vertices.size() * sizeof(BlockVertex);
+    write(page.vertexBuffer, vertexOffset(sectionMesh.firstSlot), mesh.vertices.data(), size);
+    _origins.assign(slotCount, glm::ivec4(origin, 0));
+    write(page.originBuffer, originOffset(sectionMesh.firstSlot), _origins.data(), slotCount * sizeof(glm::ivec4));
+
+    _uploadStats.meshes++;
+    _uploadStats.bytes += size;
+    _uploadStats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ChunkRenderer::remove(const glm::ivec3 &sectionPos) {
+    auto iterator = _meshes.find(sectionPos);
+    if (iterator == _meshes.end()) {
+        return;
+    }
+    freeSlots(iterator->second);
+    _vertexBytes -= iterator->second.vertexCount * sizeof(BlockVertex);
+
+    // the last mesh takes over the removed one's box
+    std::size_t boxIndex = iterator->second.boxIndex;
+    _boxes.swapRemove(boxIndex);
+    _positions[boxIndex] = _positions.back();
+    _positions.pop_back();
+    if (boxIndex < _positions.size()) {
+        _meshes[_positions[boxIndex]].boxIndex = boxIndex;
+    }
+    _meshes.erase(iterator);
+}
+
+void ChunkRenderer::submit(RenderQueue &queue, const Shader &shader, const Camera &camera, JobSystem &jobs) {
+    _shader = &shader;
+    _drawCalls = 0;
+    // the copies of this frame's uploads have all been issued by now
+    _stream.endFrame();
+
+    // one page is checked a frame, which is plenty for something that happens this rarely
+    if (!_pages.empty()) {
+        _nextCompactionCheck = (_nextCompactionCheck + 1) % _pages.size();
+        if (shouldCompact(_pages[_nextCompactionCheck])) {
+            compact(static_cast<std::uint32_t>(_nextCompactionCheck));
+        }
+    }
+
+    camera.frustum().cull(_boxes, _visible);
+    glm::vec3 eye = camera.position;
+    jobs.parallelFor(_visible.size(), SUBMIT_BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            std::uint32_t boxIndex = _visible[i];
+            const glm::ivec3 &sectionPos = _positions[boxIndex];
+            const SectionMesh &mesh = _meshes.find(sectionPos)->second;
+            glm::vec3 center = glm::vec3(sectionPos * ChunkSection::SIZE) + glm::vec3(ChunkSection::SIZE / 2.0f);
+            float depth = glm::length(center - eye);
+            for (std::size_t pass = 0; pass < RENDER_PASS_COUNT; pass++) {
+                if (mesh.passVertexCounts[pass] > 0) {
+                    std::uint64_t key = RenderQueue::key(static_cast<RenderPass>(pass), shader.id(), mesh.page, depth);
+                    queue.submit(key, *this, static_cast<std::uint32_t>(boxIndex * RENDER_PASS_COUNT + pass));
+                }
+            }
+        }
+    });
+}
+
+void ChunkRenderer::draw(const RenderQueue::Packet *begin, const RenderQueue::Packet *end) {
+    _shader->use();
+
+    _counts.clear();
+    _baseVertices.clear();
+    _drawPages.clear();
+    for (const RenderQueue::Packet *packet = begin; packet != end; packet++) {
+        std::uint32_t boxIndex = packet->item / RENDER_PASS_COUNT;
+        std::uint32_t pass = packet->item % RENDER_PASS_COUNT;
+        const SectionMesh &mesh = _meshes.find(_positions[boxIndex])->second;
+        // the passes come one after the other in the mesh. any vertex of the mesh finds its origin, so the
+        // base vertex can point into the middle of it.
+        std::uint32_t firstVertex = mesh.firstSlot * VERTICES_PER_SLOT;
+        for (std::uint32_t earlierPass = 0; earlierPass < pass; earlierPass++) {
+            firstVertex += mesh.passVertexCounts[earlierPass];
+        }
+        _counts.push_back(static_cast<GLsizei>(mesh.passVertexCounts[pass] / 4 * 6));
+        _baseVertices.push_back(static_cast<GLint>(firstVertex));
+        _drawPages.push_back(mesh.page);
+    }
+
+    if (_indirectBuffer) {
+        _commands.clear();
+        for (std::size_t i = 0; i < _counts.size(); i++) {
+            _commands.push_back({static_cast<GLuint>(_counts[i]), 1, 0, _baseVertices[i], 0});
+        }
+        GLState::bindBuffer(DRAW_INDIRECT_BUFFER, _indirectBuffer);
+        glBufferData(DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(_commands.size() * sizeof(DrawCommand)),
+            _commands.data(), GL_STREAM_DRAW);
+        _commandMemory.resize(_commands.size() * sizeof(DrawCommand));
+    } else if (_indexOffsets.size() < _counts.size()) {
+        _indexOffsets.resize(_counts.size(), nullptr);
+    }
+
+    // the packets are sorted by page unless they're translucent, then the page changes whenever it has to
+    for (std::size_t first = 0; first < _drawPages.size();) {
+        std::size_t last = first + 1;
+        while (last < _drawPages.size() && _drawPages[last] == _drawPages[first]) {
+            last++;
+        }
+        const Page &page = _pages[_drawPages[first]];
+        GLState::bindVertexArray(page.vao);
+        GLState::bindTexture(ORIGIN_TEXTURE_UNIT, GL_TEXTURE_BUFFER, page.originTexture);
+        auto drawCount = static_cast<GLsizei>(last - first);
+        if (_indirectBuffer) {
+            multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                reinterpret_cast<const void *>(first * sizeof(DrawCommand)), drawCount, 0);
+        } else {
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, _counts.data() + first, GL_UNSIGNED_INT,
+                _indexOffsets.data(), drawCount, const_cast<GLint *>(_baseVertices.data() + first));
+        }
+        _drawCalls++;
+        first = last;
+    }
+}
+
+const ChunkRenderer::UploadStats &ChunkRenderer::uploadStats() const {
+    return _uploadStats;
+}
+
+void ChunkRenderer::resetUploadStats() {
+    _uploadStats = {};
+}
+
+ChunkRenderer::GeometryStats ChunkRenderer::geometryStats() const {
+    GeometryStats stats{};
+    std::size_t freeBytes = 0;
+    for (const auto &page : _pages) {
+        stats.pages++;
+        stats.capacityBytes += vertexOffset(page.slots.capacity());
+        stats.allocatedBytes += vertexOffset(page.slots.used());
+        stats.freeRanges += page.slots.freeRangeCount();
+        stats.largestFreeBytes = std::max(stats.largestFreeBytes, vertexOffset(page.slots.largestFreeRange()));
+        freeBytes += vertexOffset(page.slots.capacity() - page.slots.used());
+    }
+    stats.vertexBytes = _vertexBytes;
+    stats.fragmentation = freeBytes > 0
+        ? 1.0f - static_cast<float>(stats.largestFreeBytes) / static_cast<float>(freeBytes) : 0.0f;
+    stats.compactions = _compactions;
+    return stats;
+}
+
+std::size_t ChunkRenderer::meshCount() const {
+    return _meshes.size();
+}
+
+std::size_t ChunkRenderer::visibleCount() const {
+    return _visible.size();
+}
+
+std::size_t ChunkRenderer::drawCallCount() const {
+    return _drawCalls;
+}
+
+void ChunkRenderer::allocateSlots(SectionMesh &mesh, std::uint32_t slotCount) {
+    for (std::uint32_t page = 0; page < _pages.size(); page++) {
+        if (_pages[page].slots.allocate(slotCount, mesh.firstSlot)) {
+            mesh.page = page;
+            mesh.slotCount = slotCount;
+            return;
+        }
+    }
+    // a page with enough free space that is just too split up is compacted rather than adding a new one
+    for (std::uint32_t page = 0; page < _pages.size(); page++) {
+        const RangeAllocator &slots = _pages[page].slots;
+        if (slots.capacity() - slots.used() >= slotCount) {
+            compact(page);
+            if (_pages[page].slots.allocate(slotCount, mesh.firstSlot)) {
+                mesh.page = page;
+                mesh.slotCount = slotCount;
+                return;
+            }
+        }
+    }
+    createPage();
+    mesh.page = static_cast<std::uint32_t>(_pages.size() - 1);
+    _pages.back().slots.allocate(slotCount, mesh.firstSlot);
+    mesh.slotCount = slotCount;
+}
+
+void ChunkRenderer::freeSlots(SectionMesh &mesh) {
+    if (mesh.slotCount == 0) {
+        return;
+    }
+    _pages[mesh.page].slots.free(mesh.firstSlot, mesh.slotCount);
+    mesh.slotCount = 0;
+}
+
+void ChunkRenderer::createPage() {
+    Page &page = _pages.emplace_back();
+    page.vertexBuffer = createBuffer(vertexOffset(PAGE_SLOTS));
+    page.originBuffer = createBuffer(originOffset(PAGE_SLOTS));
+    _geometryMemory.resize(_geometryMemory.bytes() + vertexOffset(PAGE_SLOTS) + originOffset(PAGE_SLOTS));
+
+    glGenVertexArrays(1, &page.vao);
+    GLState::bindVertexArray(page.vao);
+    setVertexAttributes(page.vertexBuffer);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+
+    glGenTextures(1, &page.originTexture);
+    GLState::bindTexture(ORIGIN_TEXTURE_UNIT, GL_TEXTURE_BUFFER, page.originTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, page.originBuffer);
+}
+
+void ChunkRenderer::compact(std::uint32_t pageIndex) {
+    Page &page = _pages[pageIndex];
+    std::vector<SectionMesh *> meshes;
+    for (auto &[pos, mesh] : _meshes) {
+        if (mesh.page == pageIndex && mesh.slotCount > 0) {
+            meshes.push_back(&mesh);
+        }
+    }
+    std::sort(meshes.begin(), meshes.end(), [](const SectionMesh *a, const SectionMesh *b) {
+        return a->firstSlot < b->firstSlot;
+    });
+
+    // copying into new buffers means source and destination never overlap
+    unsigned int vertexBuffer = createBuffer(vertexOffset(PAGE_SLOTS));
+    unsigned int originBuffer = createBuffer(originOffset(PAGE_SLOTS));
+    std::uint32_t nextSlot = 0;
+    for (SectionMesh *mesh : meshes) {
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, page.vertexBuffer);
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(vertexOffset(mesh->firstSlot)),
+            static_cast<GLintptr>(vertexOffset(nextSlot)), static_cast<GLsizeiptr>(vertexOffset(mesh->slotCount)));
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, page.originBuffer);
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, originBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(originOffset(mesh->firstSlot)),
+            static_cast<GLintptr>(originOffset(nextSlot)), static_cast<GLsizeiptr>(originOffset(mesh->slotCount)));
+        mesh->firstSlot = nextSlot;
+        nextSlot += mesh->slotCount;
+    }
+
+    GLState::deleteBuffers(1, &page.vertexBuffer);
+    GLState::deleteBuffers(1, &page.originBuffer);
+    page.vertexBuffer = vertexBuffer;
+    page.originBuffer = originBuffer;
+    GLState::bindVertexArray(page.vao);
+    setVertexAttributes(page.vertexBuffer);
+    GLState::bindTexture(ORIGIN_TEXTURE_UNIT, GL_TEXTURE_BUFFER, page.originTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, page.originBuffer);
+
+    // every mesh frees its own part of the one used range later, which the allocator handles fine
+    std::uint32_t used;
+    page.slots.clear();
+    if (nextSlot > 0) {
+        page.slots.allocate(nextSlot, used);
+    }
+    _compactions++;
+}
+
+bool ChunkRenderer::shouldCompact(const Page &page) const {
+    float freeSpace = static_cast<float>(page.slots.capacity() - page.slots.used()) / page.slots.capacity();
+    return page.slots.used() > 0 && freeSpace >= COMPACT_FREE_SPACE
+        && page.slots.fragmentation() > COMPACT_FRAGMENTATION;
+}
+
+void ChunkRenderer::write(unsigned int buffer, std::size_t offset, const void *data, std::size_t size) {
+    std::size_t streamOffset;
+    if (_stream.write(data, size, streamOffset)) {
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, _stream.buffer());
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(streamOffset),
+            static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+    } else {
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+        _uploadStats.directUploads++;
+    }
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "Frustum.h"
+#include "Memory.h"
+#include "Mesher.h"
+#include "RangeAllocator.h"
+#include "RenderQueue.h"
+#include "ShaderUniforms.h"
+#include "StreamBuffer.h"
+#include "World.h"
+
+struct Camera;
+class JobSystem;
+class Shader;
+
+// Keeps the uploaded mesh of every visible section on the GPU and draws the ones inside the camera's
+// frustum. Needs a current OpenGL context.
+//
+// Meshes don't get buffers of their own. They share a few big pages, each one vertex buffer split into
+// slots by a RangeAllocator, and every page is drawn with a single multi-draw call. The vertex shader
+// finds a vertex's section origin through gl_VertexID, which counts from the start of the page: every
+// slot has its section's origin in a texture buffer next to the vertices.
+//
+// Drawing goes through a RenderQueue: every visible section submits one packet for each pass it has quads
+// in, and the sorted packets come back to draw, where runs of them in the same page become one multi-draw.
+class ChunkRenderer : public RenderQueue::Drawer {
+public:
+    // big enough for a few hundred typical sections a frame
+    static constexpr std::size_t STREAM_BUFFER_SIZE = 32 * 1024 * 1024;
+    // has to match the vertex shader
+    static constexpr std::uint32_t VERTICES_PER_SLOT = 256;
+    // 2M vertices a page
+    static constexpr std::uint32_t PAGE_SLOTS = 8192;
+    // a page is compacted when at least this much of it is free, but split up so much that
+    // fragmentation() is above COMPACT_FRAGMENTATION
+    static constexpr float COMPACT_FREE_SPACE = 0.25f;
+    static constexpr float COMPACT_FRAGMENTATION = 0.5f;
+    // texture unit the origins of the page being drawn are bound to
+    static constexpr int ORIGIN_TEXTURE_UNIT = Shaders::textureUnit(Uniform::ORIGINS);
+    // visible sections are submitted to the render queue in parallel in groups of this many
+    static constexpr std::size_t SUBMIT_BATCH_SIZE = 256;
+
+    struct UploadStats {
+        std::size_t meshes{0};
+        std::size_t bytes{0};
+        // uploads that couldn't go through the stream buffer and were handed to the driver directly
+        std::size_t directUploads{0};
+        // cpu time spent in upload
+        double seconds{0.0};
+    };
+
+    struct GeometryStats {
+        std::size_t pages{0};
+        std::size_t capacityBytes{0};
+        // allocated slots, including the unused end of each mesh's last slot
+        std::size_t allocatedBytes{0};
+        std::size_t vertexBytes{0};
+        std::size_t freeRanges{0};
+        std::size_t largestFreeBytes{0};
+        // of all pages together, see RangeAllocator::fragmentation
+        float fragmentation{0.0f};
+        std::size_t compactions{0};
+    };
+
+private:
+    struct SectionMesh {
+        std::uint32_t page{0};
+        std::uint32_t firstSlot{0};
+        // 0 while the mesh has no slots
+        std::uint32_t slotCount{0};
+        std::uint32_t vertexCount{0};
+        // see MeshData
+        std::array<std::uint32_t, RENDER_PASS_COUNT> passVertexCounts{};
+        // index into _boxes and _positions
+        std::size_t boxIndex{0};
+    };
+
+    struct Page {
+        unsigned int vao{0};
+        unsigned int vertexBuffer{0};
+        // one ivec4 per slot
+        unsigned int originBuffer{0};
+        unsigned int originTexture{0};
+        RangeAllocator slots{PAGE_SLOTS};
+    };
+
+    struct DrawCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    std::unordered_map<glm::ivec3, SectionMesh, SectionPosHash> _meshes{};
+    // bounds of every mesh in world space and which section each one belongs to, in the same order
+    BoxList _boxes{};
+    std::vector<glm::ivec3> _positions{};
+    std::vector<std::uint32_t> _visible{};
+
+    std::vector<Page> _pages{};
+    std::size_t _nextCompactionCheck{0};
+    std::size_t _compactions{0};
+    std::size_t _vertexBytes{0};
+
+    // every quad uses the same 0 1 2 2 3 0 pattern, so one index buffer is shared by all meshes
+    unsigned int _indexBuffer{0};
+    // 0 unless glMultiDrawElementsIndirect is there
+    unsigned int _indirectBuffer{0};
+    // the draws of one run of packets, and the page of each
+    std::vector<GLsizei> _counts{};
+    std::vector<GLint> _baseVertices{};
+    std::vector<std::uint32_t> _drawPages{};
+    std::vector<DrawCommand> _commands{};
+    // glMultiDrawElementsBaseVertex wants an index offset per draw, which is always 0 here
+    std::vector<const void *> _indexOffsets{};
+    std::size_t _drawCalls{0};
+    // the pages and the index buffer, and the draw commands
+    Memory::Allocation _geometryMemory{MemoryDomain::GPU, MemoryTag::MESHES, 0};
+    Memory::Allocation _commandMemory{MemoryDomain::GPU, MemoryTag::RENDERING, 0};
+    // the shader of the last submit, used by draw
+    const Shader *_shader{nullptr};
+
+    // vertices are written here and copied into the section's buffer on the GPU
+    StreamBuffer _stream{STREAM_BUFFER_SIZE, MemoryTag::MESHES};
+    UploadStats _uploadStats{};
+    std::vector<glm::ivec4> _origins{};
+
+public:
+    ChunkRenderer();
+    ~ChunkRenderer() override;
+    ChunkRenderer(const ChunkRenderer &other) = delete;
+    ChunkRenderer &operator=(const ChunkRenderer &other) = delete;
+
+    // replaces the section's mesh. an empty mesh removes it.
+    void upload(const glm::ivec3 &sectionPos, const MeshData &mesh);
+    void remove(const glm::ivec3 &sectionPos);
+
+    // submits the sections inside the camera's frustum, farther ones with a greater depth. the shader needs
+    // the Frame block to be filled in by the time the queue is executed, and an origins sampler.
+    void submit(RenderQueue &queue, const Shader &shader, const Camera &camera, JobSystem &jobs);
+    // packet items are the section's index in _positions times RENDER_PASS_COUNT plus the pass
+    void draw(const RenderQueue::Packet *begin, const RenderQueue::Packet *end) override;
+
+    const UploadStats &uploadStats() const;
+    void resetUploadStats();
+    GeometryStats geometryStats() const;
+
+    std::size_t meshCount() const;
+    // sections that passed culling in the last submit
+    std::size_t visibleCount() const;
+    // draw calls made since the last submit
+    std::size_t drawCallCount() const;
+
+private:
+    void allocateSlots(SectionMesh &mesh, std::uint32_t slotCount);
+    void freeSlots(SectionMesh &mesh);
+    void createPage();
+    // moves every mesh in the page to the front of a new buffer, leaving all free space in one range
+    void compact(std::uint32_t pageIndex);
+    bool shouldCompact(const Page &page) const;
+    // copies data to offset in buffer, through the stream buffer when there's room
+    void write(unsigned int buffer, std::size_t offset, const void *data, std::size_t size);
+};
@@ -0,0 +1,316 @@
+#include "ChunkSection.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    unsigned int readPacked(const ChunkSection::Storage<std::uint64_t> &data, unsigned int bits, int index) {
+        // bits always divides 64, so a value never straddles two words
+        std::size_t bitIndex = static_cast<std::size_t>(index) * bits;
+        std::uint64_t mask = (std::uint64_t{1} << bits) - 1;
+        return static_cast<unsigned int>((data[bitIndex >> 6] >> (bitIndex & 63)) & mask);
+    }
+
+    void writePacked(ChunkSection::Storage<std::uint64_t> &data, unsigned int bits, int index, unsigned int value) {
+        std::size_t bitIndex = static_cast<std::size_t>(index) * bits;
+        std::uint64_t mask = (std::uint64_t{1} << bits) - 1;
+        std::uint64_t &word = data[bitIndex >> 6];
+        word = (word & ~(mask << (bitIndex & 63))) | ((value & mask) << (bitIndex & 63));
+    }
+
+    unsigned int capacityOf(unsigned int bits) {
+        return 1u << bits;
+    }
+
+    // saves are little endian regardless of the machine
+    template<typename T>
+    void putLittleEndian(std::vector<std::uint8_t> &out, T value) {
+        for (std::size_t i = 0; i < sizeof(T); i++) {
+            out.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    template<typename T>
+    T getLittleEndian(const std::uint8_t *&data, const std::uint8_t *end) {
+        if (static_cast<std::size_t>(end - data) < sizeof(T)) {
+            throw std::runtime_error("Could not read chunk section: unexpected end of data");
+        }
+        T value = 0;
+        for (std::size_t i = 0; i < sizeof(T); i++) {
+            value |= static_cast<T>(static_cast<T>(data[i]) << (i * 8));
+        }
+        data += sizeof(T);
+        return value;
+    }
+}
+
+ChunkSection::ChunkSection(BlockId fill) :
+    _palette{fill},
+    _paletteRefs{static_cast<std::uint16_t>(VOLUME)},
+    _usedPaletteEntries(1),
+    _nonAirBlocks(fill == Blocks::AIR ? 0 : VOLUME) {
+}
+
+ChunkSection::ChunkSection(const BlockId *blocks) {
+    std::uint16_t indices[VOLUME];
+    BlockId lastBlock = Blocks::AIR;
+    unsigned int lastIndex = 0;
+    for (int i = 0; i < VOLUME; i++) {
+        // neighbouring blocks are usually the same, so skip the palette search for runs
+        if (i == 0 || blocks[i] != lastBlock) {
+            lastBlock = blocks[i];
+            lastIndex = 0;
+            while (lastIndex < _palette.size() && _palette[lastIndex] != lastBlock) {
+                lastIndex++;
+            }
+            if (lastIndex == _palette.size()) {
+                _palette.push_back(lastBlock);
+                _paletteRefs.push_back(0);
+            }
+        }
+        indices[i] = static_cast<std::uint16_t>(lastIndex);
+        _paletteRefs[lastIndex]++;
+        if (lastBlock != Blocks::AIR) {
+            _nonAirBlocks++;
+        }
+    }
+
+    _usedPaletteEntries = static_cast<unsigned int>(_palette.size());
+    _bitsPerBlock = bitsFor(_usedPaletteEntries);
+    if (_bitsPerBlock != 0) {
+        _data.resize(static_cast<std::size_t>(VOLUME) * _bitsPerBlock / 64);
+        for (int i = 0; i < VOLUME; i++) {
+            writePacked(_data, _bitsPerBlock, i, indices[i]);
+        }
+    }
+}
+
+void *ChunkSection::operator new(std::size_t size) {
+    void *pointer = ::operator new(size);
+    Memory::add(MemoryDomain::CPU, MemoryTag::CHUNKS, size);
+    return pointer;
+}
+
+void ChunkSection::operator delete(void *pointer, std::size_t size) {
+    Memory::remove(MemoryDomain::CPU, MemoryTag::CHUNKS, size);
+    ::operator delete(pointer, size);
+}
+
+BlockId ChunkSection::get(int x, int y, int z) const {
+    return _palette[readIndex(index(x, y, z))];
+}
+
+void ChunkSection::set(int x, int y, int z, BlockId block) {
+    int i = index(x, y, z);
+    unsigned int oldIndex = readIndex(i);
+    BlockId oldBlock = _palette[oldIndex];
+    if (oldBlock == block) {
+        return;
+    }
+
+    // adding the entry may grow the storage, but never renumbers live entries
+    unsigned int newIndex = findOrAddPaletteEntry(block);
+    _paletteRefs[newIndex]++;
+    writeIndex(i, newIndex);
+    // releasing the entry may shrink the storage, so it has to happen last
+    releasePaletteEntry(oldIndex);
+
+    if (oldBlock == Blocks::AIR) {
+        _nonAirBlocks++;
+    } else if (block == Blocks::AIR) {
+        _nonAirBlocks--;
+    }
+}
+
+bool ChunkSection::isEmpty() const {
+    return _nonAirBlocks == 0;
+}
+
+unsigned int ChunkSection::nonAirBlocks() const {
+    return _nonAirBlocks;
+}
+
+unsigned int ChunkSection::bitsPerBlock() const {
+    return _bitsPerBlock;
+}
+
+unsigned int ChunkSection::paletteSize() const {
+    return _usedPaletteEntries;
+}
+
+void ChunkSection::setLight(int x, int y, int z, std::uint8_t light) {
+    if (_light.empty()) {
+        if (light == _uniformLight) {
+            return;
+        }
+        _light.assign(VOLUME, _uniformLight);
+    }
+    _light[index(x, y, z)] = light;
+}
+
+void ChunkSection::fillLight(std::uint8_t light) {
+    // moving an empty one in frees the array, clear wouldn't
+    _light = decltype(_light)();
+    _uniformLight = light;
+}
+
+bool ChunkSection::hasUniformLight() const {
+    return _light.empty();
+}
+
+const ChunkSection::Storage<BlockId> &ChunkSection::palette() const {
+    return _palette;
+}
+
+std::size_t ChunkSection::memoryUsage() const {
+    return sizeof(ChunkSection)
+        + _palette.capacity() * sizeof(BlockId)
+        + _paletteRefs.capacity() * sizeof(std::uint16_t)
+        + _data.capacity() * sizeof(std::uint64_t)
+        + _light.capacity();
+}
+
+void ChunkSection::serialize(std::vector<std::uint8_t> &out) const {
+    out.push_back(static_cast<std::uint8_t>(_bitsPerBlock));
+    putLittleEndian(out, static_cast<std::uint16_t>(_palette.size()));
+    for (BlockId block : _palette) {
+        putLittleEndian(out, block);
+    }
+    for (std::uint64_t word : _data) {
+        putLittleEndian(out, word);
+    }
+}
+
+std::unique_ptr<ChunkSection> ChunkSection::deserialize(const std::uint8_t *&data, const std::uint8_t *end) {
+    auto section = std::make_unique<ChunkSection>();
+    auto bits = getLittleEndian<std::uint8_t>(data, end);
+    auto paletteSize = getLittleEndian<std::uint16_t>(data, end);
+    bool validBits = bits == 0 || bits == 1 || bits == 2 || bits == 4 || bits == 8 || bits == 16;
+    if (!validBits || paletteSize == 0 || paletteSize > capacityOf(bits)) {
+        throw std::runtime_error("Could not read chunk section: invalid palette");
+    }
+
+    section->_palette.resize(paletteSize);
+    for (auto &block : section->_palette) {
+        block = getLittleEndian<BlockId>(data, end);
+    }
+    section->_bitsPerBlock = bits;
+    section->_data.resize(static_cast<std::size_t>(VOLUME) * bits / 64);
+    for (auto &word : section->_data) {
+        word = getLittleEndian<std::uint64_t>(data, end);
+    }
+
+    // refcounts aren't saved, they follow from the indices
+    section->_paletteRefs.assign(paletteSize, 0);
+    for (int i = 0; i < VOLUME; i++) {
+        unsigned int index = section->readIndex(i);
+        if (index >= paletteSize) {
+            throw std::runtime_error("Could not read chunk section: palette index out of range");
+        }
+        section->_paletteRefs[index]++;
+    }
+    section->_usedPaletteEntries = 0;
+    section->_nonAirBlocks = 0;
+    for (unsigned int i = 0; i < paletteSize; i++) {
+        if (section->_paletteRefs[i] != 0) {
+            section->_usedPaletteEntries++;
+            if (section->_palette[i] != Blocks::AIR) {
+                section->_nonAirBlocks += section->_paletteRefs[i];
+            }
+        }
+    }
+    return section;
+}
+
+unsigned int ChunkSection::readIndex(int index) const {
+    if (_bitsPerBlock == 0) {
+        return 0;
+    }
+    return readPacked(_data, _bitsPerBlock, index);
+}
+
+void ChunkSection::writeIndex(int index, unsigned int paletteIndex) {
+    writePacked(_data, _bitsPerBlock, index, paletteIndex);
+}
+
+unsigned int ChunkSection::findOrAddPaletteEntry(BlockId block) {
+    auto freeIndex = static_cast<unsigned int>(_palette.size());
+    for (unsigned int i = 0; i < _palette.size(); i++) {
+        if (_paletteRefs[i] == 0) {
+            if (freeIndex == _palette.size()) {
+                freeIndex = i;
+            }
+        } else if (_palette[i] == block) {
+            return i;
+        }
+    }
+
+    _usedPaletteEntries++;
+    if (freeIndex < _palette.size()) {
+        _palette[freeIndex] = block;
+        return freeIndex;
+    }
+
+    // no free slot, so the palette has to grow. there are no free entries to drop either, which means
+    // repacking keeps every existing index where it was.
+    auto newSize = static_cast<unsigned int>(_palette.size() + 1);
+    if (newSize > capacityOf(_bitsPerBlock)) {
+        repack(bitsFor(newSize));
+    }
+    _palette.push_back(block);
+    _paletteRefs.push_back(0);
+    return newSize - 1;
+}
+
+void ChunkSection::releasePaletteEntry(unsigned int paletteIndex) {
+    if (--_paletteRefs[paletteIndex] != 0) {
+        return;
+    }
+    _usedPaletteEntries--;
+
+    // only shrink once the smaller size would be at most half full, otherwise a block toggling back and
+    // forth on the boundary would repack the whole section every time. going back to a single block
+    // is always worth it though.
+    unsigned int targetBits = bitsFor(_usedPaletteEntries);
+    if (_usedPaletteEntries == 1 || (targetBits < _bitsPerBlock && capacityOf(targetBits) >= 2 * _usedPaletteEntries)) {
+        repack(targetBits);
+    }
+}
+
+void ChunkSection::repack(unsigned int bitsPerBlock) {
+    Storage<BlockId> palette;
+    Storage<std::uint16_t> paletteRefs;
+    std::vector<unsigned int> remap(_palette.size());
+    palette.reserve(_usedPaletteEntries);
+    paletteRefs.reserve(_usedPaletteEntries);
+    for (unsigned int i = 0; i < _palette.size(); i++) {
+        if (_paletteRefs[i] != 0) {
+            remap[i] = static_cast<unsigned int>(palette.size());
+            palette.push_back(_palette[i]);
+            paletteRefs.push_back(_paletteRefs[i]);
+        }
+    }
+
+    Storage<std::uint64_t> data;
+    if (bitsPerBlock != 0) {
+        data.resize(static_cast<std::size_t>(VOLUME) * bitsPerBlock / 64);
+        for (int i = 0; i < VOLUME; i++) {
+            writePacked(data, bitsPerBlock, i, remap[readIndex(i)]);
+        }
+    }
+
+    _palette = std::move(palette);
+    _paletteRefs = std::move(paletteRefs);
+    _data = std::move(data);
+    _bitsPerBlock = bitsPerBlock;
+}
+
+unsigned int ChunkSection::bitsFor(unsigned int paletteEntries) {
+    if (paletteEntries <= 1) return 0;
+    if (paletteEntries <= 2) return 1;
+    if (paletteEntries <= 4) return 2;
+    if (paletteEntries <= 16) return 4;
+    if (paletteEntries <= 256) return 8;
+    return 16;
+}
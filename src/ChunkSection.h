@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Block.h"
+#include "Light.h"
+#include "Memory.h"
+
+// A 16x16x16 cube of blocks. Blocks are stored as indices into a per-section palette, packed into
+// 64 bit words with 1, 2, 4, 8 or 16 bits per block depending on how many distinct blocks the section
+// contains. A section made of a single block (usually air) stores no block data at all.
+//
+// Light is kept next to the blocks, one byte per block (see Light.h). Like the blocks, a section where
+// every block has the same light doesn't allocate any.
+class ChunkSection {
+public:
+    static constexpr int SIZE = 16;
+    static constexpr int AREA = SIZE * SIZE;
+    static constexpr int VOLUME = SIZE * SIZE * SIZE;
+
+    // for block data, which counts towards MemoryTag::CHUNKS
+    template<typename T>
+    using Storage = Memory::Vector<T, MemoryTag::CHUNKS>;
+
+private:
+    // palette index -> block id. entries whose refcount dropped to 0 are free and get reused
+    Storage<BlockId> _palette{};
+    Storage<std::uint16_t> _paletteRefs{};
+    Storage<std::uint64_t> _data{};
+    unsigned int _bitsPerBlock{0};
+    unsigned int _usedPaletteEntries{0};
+    unsigned int _nonAirBlocks{0};
+    // VOLUME bytes in index() order, or empty while every block has _uniformLight
+    Memory::Vector<std::uint8_t, MemoryTag::LIGHT> _light{};
+    std::uint8_t _uniformLight{Light::FULL_SKY};
+
+public:
+    explicit ChunkSection(BlockId fill = Blocks::AIR);
+    // builds the palette from VOLUME blocks in index() order, much faster than setting them one by one
+    explicit ChunkSection(const BlockId *blocks);
+
+    // sections themselves count towards MemoryTag::CHUNKS too
+    static void *operator new(std::size_t size);
+    static void operator delete(void *pointer, std::size_t size);
+
+    BlockId get(int x, int y, int z) const;
+    void set(int x, int y, int z, BlockId block);
+
+    std::uint8_t getLight(int x, int y, int z) const {
+        return _light.empty() ? _uniformLight : _light[index(x, y, z)];
+    }
+    void setLight(int x, int y, int z, std::uint8_t light);
+    // gives every block the same light and frees the per block array
+    void fillLight(std::uint8_t light);
+    bool hasUniformLight() const;
+
+    // every block id the section may contain. can include ids no block uses anymore.
+    const Storage<BlockId> &palette() const;
+
+    // true if every block in this section is air
+    bool isEmpty() const;
+    unsigned int nonAirBlocks() const;
+
+    unsigned int bitsPerBlock() const;
+    unsigned int paletteSize() const;
+
+    // the number of heap and inline bytes used by this section
+    std::size_t memoryUsage() const;
+
+    // appends the section in the save format: bits per block, palette, then the packed indices as is
+    void serialize(std::vector<std::uint8_t> &out) const;
+    // reads a section written by serialize and advances data past it. throws if the data is malformed.
+    static std::unique_ptr<ChunkSection> deserialize(const std::uint8_t *&data, const std::uint8_t *end);
+
+    static int index(int x, int y, int z) {
+        return (y << 8) | (z << 4) | x;
+    }
+
+private:
+    unsigned int readIndex(int index) const;
+    void writeIndex(int index, unsigned int paletteIndex);
+
+    unsigned int findOrAddPaletteEntry(BlockId block);
+    void releasePaletteEntry(unsigned int paletteIndex);
+
+    // repacks every block using the given amount of bits, dropping any free palette entries
+    void repack(unsigned int bitsPerBlock);
+
+    static unsigned int bitsFor(unsigned int paletteEntries);
+};
@@ -0,0 +1,626 @@
+#include "ChunkStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <shared_mutex>
+#include <unordered_set>
+#include <utility>
+
+#include <glm/geometric.hpp>
+
+#include "Camera.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "TerrainGenerator.h"
+#include "WorldStorage.h"
+
+namespace {
+    // the queues are only re-sorted once the camera has turned further than this (about 25 degrees)
+    constexpr float RESORT_COS_ANGLE = 0.9f;
+    // dirty sections are meshed on the main thread up to this many, and spread over the workers beyond
+    constexpr std::size_t INLINE_REMESH_LIMIT = 8;
+    // columns lit together in one batch
+    constexpr std::size_t LIGHT_BATCH_SIZE = 32;
+    // updates in a row that may skip the world's changes because the workers were holding it, before one
+    // waits for them after all
+    constexpr unsigned int MAX_DEFERRED_UPDATES = 8;
+
+    int distanceSquared(const glm::ivec2 &a, const glm::ivec2 &b) {
+        glm::ivec2 offset = a - b;
+        return offset.x * offset.x + offset.y * offset.y;
+    }
+
+    const glm::ivec2 NEIGHBOURS[8] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    // shared by column and edit meshing on each thread, since the scratch buffers aren't small
+    Mesher &threadMesher() {
+        thread_local Mesher mesher;
+        return mesher;
+    }
+}
+
+ChunkStreamer::ChunkStreamer(World &world, WorldStorage &storage, const TerrainGenerator &generator,
+    JobSystem &jobs, int viewDistance) :
+    _world(world),
+    _storage(storage),
+    _generator(generator),
+    _jobs(jobs),
+    _viewDistance(viewDistance),
+    _isLit([this](const glm::ivec2 &pos) { return isLit(pos); }) {
+    // the job system may not be constructed yet, so it isn't touched here
+}
+
+ChunkStreamer::~ChunkStreamer() {
+    // jobs that haven't run yet see this and do nothing
+    for (auto &[pos, column] : _columns) {
+        column.cancelled->store(true);
+    }
+}
+
+void ChunkStreamer::update(const Camera &camera) {
+    _cameraPosition = camera.position;
+    _cameraFront = camera.front;
+
+    // light and mesh jobs hold the world shared while they work on a column, and the lock lets readers in
+    // ahead of a waiting writer, so blocking here could take longer than a frame. if the workers have it,
+    // everything that changes the world waits for the next update instead, and new jobs still go out.
+    std::unique_lock<std::shared_mutex> lock(_world.mutex(), std::try_to_lock);
+    if (!lock.owns_lock()) {
+        if (_deferredInARow < MAX_DEFERRED_UPDATES) {
+            _deferredInARow++;
+            _deferredUpdates++;
+            dispatch();
+            return;
+        }
+        lock.lock();
+    }
+    _deferredInARow = 0;
+
+    collectResults();
+    relightChangedBlocks();
+    _world.takeDirtySections(_dirtySections);
+    glm::ivec2 center(static_cast<int>(std::floor(camera.position.x / ChunkSection::SIZE)),
+        static_cast<int>(std::floor(camera.position.z / ChunkSection::SIZE)));
+    if (!_hasCenter || center != _center) {
+        recenter(center);
+    } else if (glm::dot(_cameraFront, _sortedFront) < RESORT_COS_ANGLE) {
+        _queuesNeedSort = true;
+    }
+    lock.unlock();
+
+    // meshing takes the world shared itself
+    remeshDirtySections();
+    dispatch();
+}
+
+std::size_t ChunkStreamer::takeMeshes(std::vector<FinishedMesh> &out, std::size_t budget) {
+    for (auto &mesh : _editedMeshes) {
+        out.push_back(std::move(mesh));
+    }
+    _editedMeshes.clear();
+
+    std::size_t taken = 0;
+    while (taken < budget && !_readyMeshes.empty()) {
+        FinishedMesh mesh = std::move(_readyMeshes.front());
+        _readyMeshes.pop_front();
+
+        // the column may have been unloaded after the mesh was finished
+        auto column = _columns.find(glm::ivec2(mesh.sectionPos.x, mesh.sectionPos.z));
+        if (column == _columns.end() || column->second.state != ColumnState::MESHED) {
+            recycle(std::move(mesh.mesh));
+            continue;
+        }
+        out.push_back(std::move(mesh));
+        taken++;
+    }
+    return taken;
+}
+
+void ChunkStreamer::takeRemovedSections(std::vector<glm::ivec3> &out) {
+    out.insert(out.end(), _removedSections.begin(), _removedSections.end());
+    _removedSections.clear();
+}
+
+void ChunkStreamer::recycle(MeshData &&mesh) {
+    mesh.clear();
+    std::lock_guard<std::mutex> lock(_meshPoolMutex);
+    if (_meshPool.size() < MAX_POOLED_MESHES) {
+        _meshPool.push_back(std::move(mesh));
+    }
+}
+
+std::size_t ChunkStreamer::loadedColumnCount() const {
+    std::size_t count = 0;
+    for (const auto &[pos, column] : _columns) {
+        if (isLoaded(pos)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+unsigned int ChunkStreamer::jobsInFlight() const {
+    return _jobsInFlight;
+}
+
+std::size_t ChunkStreamer::deferredUpdates() const {
+    return _deferredUpdates;
+}
+
+void ChunkStreamer::collectResults() {
+    std::vector<LoadResult> loadResults;
+    std::vector<LightResult> lightResults;
+    std::vector<MeshResult> meshResults;
+    {
+        std::lock_guard<std::mutex> lock(_resultsMutex);
+        loadResults.swap(_loadResults);
+        lightResults.swap(_lightResults);
+        meshResults.swap(_meshResults);
+    }
+    _jobsInFlight -= static_cast<unsigned int>(loadResults.size() + lightResults.size() + meshResults.size());
+
+    for (auto &result : loadResults) {
+        auto column = _columns.find(result.pos);
+        if (column == _columns.end() || column->second.cancelled != result.cancelled || *result.cancelled) {
+            continue;
+        }
+        _world.setColumn(result.pos.x, result.pos.y, std::move(result.sections));
+        column->second.state = ColumnState::LOADED;
+    }
+    // a column can only be lit once its neighbours are there, so each load can unlock up to nine columns
+    for (const auto &result : loadResults) {
+        if (*result.cancelled) {
+            continue;
+        }
+        if (canLight(result.pos)) {
+            _lightQueue.push_back(result.pos);
+        }
+        for (const auto &offset : NEIGHBOURS) {
+            if (canLight(result.pos + offset)) {
+                _lightQueue.push_back(result.pos + offset);
+            }
+        }
+        _queuesNeedSort = true;
+    }
+
+    for (auto &result : lightResults) {
+        _lightingInFlight = false;
+        for (std::size_t i = 0; i < result.columns.size(); i++) {
+            auto column = _columns.find(result.columns[i]);
+            if (column != _columns.end() && column->second.cancelled == result.cancelled[i] && !*result.cancelled[i]) {
+                column->second.state = ColumnState::LIT;
+            }
+        }
+        _light.apply(_world, result.outside, _isLit);
+        // and the same again for meshing
+        for (const auto &pos : result.columns) {
+            if (canMesh(pos)) {
+                _meshQueue.push_back(pos);
+            }
+            for (const auto &offset : NEIGHBOURS) {
+                if (canMesh(pos + offset)) {
+                    _meshQueue.push_back(pos + offset);
+                }
+            }
+        }
+        _queuesNeedSort = true;
+    }
+
+    for (auto &result : meshResults) {
+        auto column = _columns.find(result.pos);
+        if (column == _columns.end() || column->second.cancelled != result.cancelled || *result.cancelled) {
+            for (auto &mesh : result.meshes) {
+                recycle(std::move(mesh.mesh));
+            }
+            continue;
+        }
+        column->second.state = ColumnState::MESHED;
+        for (auto &mesh : result.meshes) {
+            _readyMeshes.push_back(std::move(mesh));
+        }
+    }
+}
+
+void ChunkStreamer::recenter(const glm::ivec2 &center) {
+    glm::ivec2 previousCenter = _center;
+    bool hadCenter = _hasCenter;
+    _center = center;
+    _hasCenter = true;
+
+    // columns are lit one further than they are meshed and loaded one further than that, so the outermost
+    // ones in each stage have the neighbours they need. they are only unloaded one further than that
+    // again, so walking back and forth over a chunk border doesn't keep unloading and reloading one row.
+    int lightDistance = _viewDistance + 1;
+    int loadDistance = _viewDistance + 2;
+    int unloadDistance = _viewDistance + 3;
+
+    for (auto it = _columns.begin(); it != _columns.end();) {
+        if (distanceSquared(it->first, center) > unloadDistance * unloadDistance) {
+            unloadColumn(it->first, it->second);
+            it = _columns.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // stale entries are normally dropped when they reach the back, but the ones for columns left behind
+    // would sit at the front forever while flying
+    _loadQueue.erase(std::remove_if(_loadQueue.begin(), _loadQueue.end(), [this](const glm::ivec2 &pos) {
+        auto column = _columns.find(pos);
+        return column == _columns.end() || column->second.state != ColumnState::QUEUED;
+    }), _loadQueue.end());
+    auto isGone = [this](const glm::ivec2 &pos) { return !_columns.count(pos); };
+    _lightQueue.erase(std::remove_if(_lightQueue.begin(), _lightQueue.end(), isGone), _lightQueue.end());
+    _meshQueue.erase(std::remove_if(_meshQueue.begin(), _meshQueue.end(), isGone), _meshQueue.end());
+
+    for (int z = -loadDistance; z <= loadDistance; z++) {
+        for (int x = -loadDistance; x <= loadDistance; x++) {
+            glm::ivec2 pos = center + glm::ivec2(x, z);
+            if (x * x + z * z > loadDistance * loadDistance) {
+                continue;
+            }
+            auto [column, inserted] = _columns.try_emplace(pos);
+            if (inserted) {
+                _loadQueue.push_back(pos);
+                continue;
+            }
+            // columns that were just outside the lit or meshed area before may be ready now
+            if (hadCenter && distanceSquared(pos, previousCenter) > lightDistance * lightDistance && canLight(pos)) {
+                _lightQueue.push_back(pos);
+            }
+            if (hadCenter && distanceSquared(pos, previousCenter) > _viewDistance * _viewDistance && canMesh(pos)) {
+                _meshQueue.push_back(pos);
+            }
+        }
+    }
+    _queuesNeedSort = true;
+}
+
+void ChunkStreamer::unloadColumn(const glm::ivec2 &pos, Column &column) {
+    column.cancelled->store(true);
+    if (!isLoaded(pos)) {
+        return;
+    }
+
+    // saving on the main thread is rare enough to not be worth a job: only modified columns are written.
+    // a job would also have to be waited on if the column came back into view before it finished.
+    World::Column sections = _world.takeColumn(pos.x, pos.y);
+    if (_world.isColumnModified(pos.x, pos.y)) {
+        World::ColumnView view{};
+        for (int sectionY = 0; sectionY < World::COLUMN_SECTIONS; sectionY++) {
+            view[sectionY] = sections[sectionY].get();
+        }
+        try {
+            _storage.saveColumn(pos.x, pos.y, view);
+        } catch (const std::exception &exception) {
+            std::cerr << exception.what() << std::endl;
+        }
+        _world.clearModified(pos.x, pos.y);
+    }
+
+    if (column.state == ColumnState::MESHING || column.state == ColumnState::MESHED) {
+        for (int sectionY = 0; sectionY < World::COLUMN_SECTIONS; sectionY++) {
+            _removedSections.emplace_back(pos.x, sectionY, pos.y);
+        }
+    }
+}
+
+void ChunkStreamer::dispatch() {
+    if (_queuesNeedSort) {
+        _sortedFront = _cameraFront;
+        auto byPriority = [this](const glm::ivec2 &a, const glm::ivec2 &b) {
+            // most urgent at the back, so it can be popped
+            return priority(a) > priority(b);
+        };
+        std::sort(_loadQueue.begin(), _loadQueue.end(), byPriority);
+        std::sort(_lightQueue.begin(), _lightQueue.end(), byPriority);
+        std::sort(_meshQueue.begin(), _meshQueue.end(), byPriority);
+        _queuesNeedSort = false;
+    }
+
+    // one batch at a time, so batches never exchange light with each other. a batch is spread over the
+    // workers, so this doesn't cost any parallelism.
+    if (!_lightingInFlight) {
+        std::vector<glm::ivec2> batch;
+        std::vector<std::shared_ptr<std::atomic<bool>>> cancelled;
+        while (!_lightQueue.empty() && batch.size() < LIGHT_BATCH_SIZE) {
+            glm::ivec2 pos = _lightQueue.back();
+            _lightQueue.pop_back();
+            if (!canLight(pos)) {
+                continue;
+            }
+            Column &column = _columns[pos];
+            column.state = ColumnState::LIGHTING;
+            batch.push_back(pos);
+            cancelled.push_back(column.cancelled);
+        }
+        if (!batch.empty()) {
+            std::unordered_set<glm::ivec2, ColumnPosHash> litNeighbours;
+            for (const auto &pos : batch) {
+                for (const auto &offset : NEIGHBOURS) {
+                    if (isLit(pos + offset)) {
+                        litNeighbours.insert(pos + offset);
+                    }
+                }
+            }
+            JobPriority jobPriority = priority(batch.front()) < 2.0f ? JobPriority::HIGH : JobPriority::NORMAL;
+            _jobs.schedule([this, batch = std::move(batch), cancelled = std::move(cancelled),
+                litNeighbours = std::move(litNeighbours)]() mutable {
+                lightJob(std::move(batch), std::move(cancelled), std::move(litNeighbours));
+            }, jobPriority);
+            _lightingInFlight = true;
+            _jobsInFlight++;
+        }
+    }
+
+    // enough to keep every worker busy, few enough that turning around reorders the work almost at once
+    unsigned int maxJobsInFlight = std::max(4u, _jobs.workerCount() * 2);
+    while (_jobsInFlight < maxJobsInFlight) {
+        // drop anything that was unloaded or already dealt with since it was queued
+        while (!_loadQueue.empty()) {
+            auto column = _columns.find(_loadQueue.back());
+            if (column != _columns.end() && column->second.state == ColumnState::QUEUED) {
+                break;
+            }
+            _loadQueue.pop_back();
+        }
+        while (!_meshQueue.empty() && !canMesh(_meshQueue.back())) {
+            _meshQueue.pop_back();
+        }
+        if (_loadQueue.empty() && _meshQueue.empty()) {
+            break;
+        }
+
+        // meshing wins ties, it's what actually puts something on screen
+        bool meshNext = !_meshQueue.empty()
+            && (_loadQueue.empty() || priority(_meshQueue.back()) <= priority(_loadQueue.back()));
+        std::vector<glm::ivec2> &queue = meshNext ? _meshQueue : _loadQueue;
+        glm::ivec2 pos = queue.back();
+        queue.pop_back();
+
+        Column &column = _columns[pos];
+        float score = priority(pos);
+        JobPriority jobPriority = score < 2.0f ? JobPriority::HIGH : score < _viewDistance ? JobPriority::NORMAL
+            : JobPriority::LOW;
+        auto cancelled = column.cancelled;
+        if (meshNext) {
+            column.state = ColumnState::MESHING;
+            _jobs.schedule([this, pos, cancelled]() { meshJob(pos, cancelled); }, jobPriority);
+        } else {
+            column.state = ColumnState::LOADING;
+            _jobs.schedule([this, pos, cancelled]() { loadJob(pos, cancelled); }, jobPriority);
+        }
+        _jobsInFlight++;
+    }
+}
+
+void ChunkStreamer::relightChangedBlocks() {
+    _world.takeChangedBlocks(_changedBlocks);
+    if (_changedBlocks.empty()) {
+        return;
+    }
+
+    // the batch being lit may still read these blocks and doesn't know about the change yet, so anything
+    // next to it waits until the batch is done
+    auto nextToLighting = [this](const glm::ivec3 &pos) {
+        glm::ivec3 sectionPos = World::toSectionPos(pos);
+        for (int z = -1; z <= 1; z++) {
+            for (int x = -1; x <= 1; x++) {
+                auto column = _columns.find(glm::ivec2(sectionPos.x + x, sectionPos.z + z));
+                if (column != _columns.end() && column->second.state == ColumnState::LIGHTING) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    _changedBlocks.insert(_changedBlocks.end(), _deferredChanges.begin(), _deferredChanges.end());
+    _deferredChanges.clear();
+    if (_lightingInFlight) {
+        auto deferred = std::stable_partition(_changedBlocks.begin(), _changedBlocks.end(),
+            [&nextToLighting](const glm::ivec3 &pos) { return !nextToLighting(pos); });
+        _deferredChanges.assign(deferred, _changedBlocks.end());
+        _changedBlocks.erase(deferred, _changedBlocks.end());
+    }
+
+    _light.update(_world, _changedBlocks, _isLit);
+    _changedBlocks.clear();
+}
+
+void ChunkStreamer::remeshDirtySections() {
+    if (_dirtySections.empty()) {
+        return;
+    }
+
+    std::vector<glm::ivec3> sections;
+    for (const auto &sectionPos : _dirtySections) {
+        auto column = _columns.find(glm::ivec2(sectionPos.x, sectionPos.z));
+        if (sectionPos.y < 0 || sectionPos.y >= World::COLUMN_SECTIONS || column == _columns.end()) {
+            continue;
+        }
+        if (column->second.state == ColumnState::MESHED) {
+            sections.push_back(sectionPos);
+        } else if (column->second.state == ColumnState::MESHING) {
+            // the running job may have gathered the blocks before the edit. a new flag makes its result
+            // count as stale, and the column gets meshed again from scratch.
+            column->second.cancelled = std::make_shared<std::atomic<bool>>(false);
+            column->second.state = ColumnState::LIT;
+            _meshQueue.push_back(column->first);
+            _queuesNeedSort = true;
+        }
+        // columns that aren't meshed yet will see the edit when they are
+    }
+    _dirtySections.clear();
+    if (sections.empty()) {
+        return;
+    }
+
+    // a mesh that finished before the edit but wasn't handed out yet would overwrite the new one
+    if (!_readyMeshes.empty()) {
+        std::unordered_set<glm::ivec3, SectionPosHash> edited(sections.begin(), sections.end());
+        for (auto it = _readyMeshes.begin(); it != _readyMeshes.end();) {
+            if (edited.count(it->sectionPos)) {
+                recycle(std::move(it->mesh));
+                it = _readyMeshes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    std::size_t first = _editedMeshes.size();
+    _editedMeshes.resize(first + sections.size());
+    for (std::size_t i = 0; i < sections.size(); i++) {
+        _editedMeshes[first + i] = {sections[i], takePooledMesh()};
+    }
+    auto meshEdited = [this, first, &sections](std::size_t begin, std::size_t end) {
+        Mesher &mesher = threadMesher();
+        for (std::size_t i = begin; i < end; i++) {
+            meshSection(mesher, sections[i], _editedMeshes[first + i].mesh);
+        }
+    };
+    // a handful of sections is quicker to mesh right here than to hand out to the workers
+    if (sections.size() <= INLINE_REMESH_LIMIT) {
+        meshEdited(0, sections.size());
+    } else {
+        _jobs.parallelFor(sections.size(), 1, meshEdited, JobPriority::HIGH);
+    }
+}
+
+bool ChunkStreamer::isLoaded(const glm::ivec2 &pos) const {
+    auto column = _columns.find(pos);
+    return column != _columns.end() && column->second.state != ColumnState::QUEUED
+        && column->second.state != ColumnState::LOADING;
+}
+
+bool ChunkStreamer::isLit(const glm::ivec2 &pos) const {
+    auto column = _columns.find(pos);
+    return column != _columns.end() && (column->second.state == ColumnState::LIT
+        || column->second.state == ColumnState::MESHING || column->second.state == ColumnState::MESHED);
+}
+
+bool ChunkStreamer::canLight(const glm::ivec2 &pos) const {
+    auto column = _columns.find(pos);
+    int lightDistance = _viewDistance + 1;
+    if (column == _columns.end() || column->second.state != ColumnState::LOADED
+        || distanceSquared(pos, _center) > lightDistance * lightDistance) {
+        return false;
+    }
+    for (const auto &offset : NEIGHBOURS) {
+        if (!isLoaded(pos + offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ChunkStreamer::canMesh(const glm::ivec2 &pos) const {
+    auto column = _columns.find(pos);
+    if (column == _columns.end() || column->second.state != ColumnState::LIT
+        || distanceSquared(pos, _center) > _viewDistance * _viewDistance) {
+        return false;
+    }
+    for (const auto &offset : NEIGHBOURS) {
+        if (!isLit(pos + offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float ChunkStreamer::priority(const glm::ivec2 &pos) const {
+    glm::vec2 toColumn = (glm::vec2(pos) + 0.5f) * static_cast<float>(ChunkSection::SIZE)
+        - glm::vec2(_cameraPosition.x, _cameraPosition.z);
+    float distance = glm::length(toColumn) / ChunkSection::SIZE;
+    glm::vec2 front(_sortedFront.x, _sortedFront.z);
+    if (distance < 1.5f || glm::length(front) < 0.01f) {
+        // right around the camera, or looking straight up or down: every direction is just as visible
+        return distance;
+    }
+
+    // columns ahead count at their distance, ones to the side at twice and ones behind at three times it
+    float cosAngle = glm::dot(toColumn, glm::normalize(front)) / (distance * ChunkSection::SIZE);
+    return distance * (2.0f - cosAngle);
+}
+
+void ChunkStreamer::loadJob(glm::ivec2 pos, std::shared_ptr<std::atomic<bool>> cancelled) {
+    Profiler::Zone zone("ChunkStreamer::loadJob");
+    LoadResult result{pos, cancelled, {}};
+    if (!*cancelled) {
+        bool loaded = false;
+        try {
+            loaded = _storage.loadColumn(pos.x, pos.y, result.sections);
+        } catch (const std::exception &exception) {
+            std::cerr << exception.what() << ", generating it again" << std::endl;
+        }
+        // generated terrain only depends on the seed, so it isn't saved until it gets modified
+        if (!loaded) {
+            result.sections = _generator.generateColumn(pos.x, pos.y);
+        }
+        // missing sections count as open sky for lighting, which is only true above the top one
+        int topSection = World::COLUMN_SECTIONS;
+        while (topSection > 0 && !result.sections[topSection - 1]) {
+            topSection--;
+        }
+        for (int sectionY = 0; sectionY < topSection; sectionY++) {
+            if (!result.sections[sectionY]) {
+                result.sections[sectionY] = std::make_unique<ChunkSection>();
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_resultsMutex);
+    _loadResults.push_back(std::move(result));
+}
+
+void ChunkStreamer::lightJob(std::vector<glm::ivec2> columns,
+    std::vector<std::shared_ptr<std::atomic<bool>>> cancelled,
+    std::unordered_set<glm::ivec2, ColumnPosHash> litNeighbours) {
+    Profiler::Zone zone("ChunkStreamer::lightJob");
+    // cancelled columns are lit anyway. they are usually gone from the world already, and leaving them out
+    // would change how the rest of the batch exchanges light.
+    LightResult result{std::move(columns), std::move(cancelled), {}};
+    LightEngine::lightColumns(_world, result.columns, litNeighbours, _jobs, result.outside);
+
+    std::lock_guard<std::mutex> lock(_resultsMutex);
+    _lightResults.push_back(std::move(result));
+}
+
+void ChunkStreamer::meshJob(glm::ivec2 pos, std::shared_ptr<std::atomic<bool>> cancelled) {
+    Profiler::Zone zone("ChunkStreamer::meshJob");
+    Mesher &mesher = threadMesher();
+    MeshResult result{pos, cancelled, {}};
+    for (int sectionY = 0; sectionY < World::COLUMN_SECTIONS && !*cancelled; sectionY++) {
+        glm::ivec3 sectionPos(pos.x, sectionY, pos.y);
+        // empty meshes are handed out too, so the renderer drops whatever it had for the section
+        MeshData mesh = takePooledMesh();
+        meshSection(mesher, sectionPos, mesh);
+        result.meshes.push_back({sectionPos, std::move(mesh)});
+    }
+
+    std::lock_guard<std::mutex> lock(_resultsMutex);
+    _meshResults.push_back(std::move(result));
+}
+
+void ChunkStreamer::meshSection(Mesher &mesher, const glm::ivec3 &sectionPos, MeshData &out) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(_world.mutex());
+        const ChunkSection *section = _world.getSection(sectionPos);
+        if (!section || section->isEmpty()) {
+            out.clear();
+            return;
+        }
+        mesher.gather(_world, sectionPos);
+    }
+    mesher.mesh(out);
+}
+
+MeshData ChunkStreamer::takePooledMesh() {
+    std::lock_guard<std::mutex> lock(_meshPoolMutex);
+    if (_meshPool.empty()) {
+        return {};
+    }
+    MeshData mesh = std::move(_meshPool.back());
+    _meshPool.pop_back();
+    return mesh;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "LightEngine.h"
+#include "Mesher.h"
+#include "World.h"
+
+struct Camera;
+class JobSystem;
+class TerrainGenerator;
+class WorldStorage;
+
+// Loads, generates, lights, meshes and unloads chunk columns in the background as the camera moves. Work is
+// ordered by distance and by angle to where the camera looks, and only a few jobs are kept in flight
+// at a time so the order can change quickly when the player turns or teleports. Columns that leave the
+// view distance are cancelled, including any of their jobs still waiting to run.
+//
+// Columns are lit in batches, one batch at a time, once their neighbours are loaded, and meshed once their
+// neighbours are lit. Sections changed with World::setBlock are relit and remeshed right away on the next
+// update that gets the world, so edits show up within a frame or two no matter how much streaming work is
+// queued.
+//
+// Everything except the jobs themselves runs on the main thread. It never waits long for the world's mutex:
+// while the workers hold it, finished work is applied a few updates later instead.
+class ChunkStreamer {
+public:
+    static constexpr std::size_t MAX_POOLED_MESHES = 256;
+
+    struct FinishedMesh {
+        glm::ivec3 sectionPos;
+        // empty if the section has nothing to draw
+        MeshData mesh;
+    };
+
+private:
+    enum class ColumnState {
+        // waiting for a load job
+        QUEUED,
+        LOADING,
+        // in the world, waiting for its neighbours or to be lit
+        LOADED,
+        LIGHTING,
+        // waiting for its neighbours or a mesh job
+        LIT,
+        MESHING,
+        MESHED
+    };
+
+    struct Column {
+        ColumnState state{ColumnState::QUEUED};
+        // shared with this column's jobs. set when the column is unloaded, so the jobs can skip their
+        // work and their results are thrown away.
+        std::shared_ptr<std::atomic<bool>> cancelled{std::make_shared<std::atomic<bool>>(false)};
+    };
+
+    struct LoadResult {
+        glm::ivec2 pos;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        World::Column sections;
+    };
+
+    struct LightResult {
+        std::vector<glm::ivec2> columns;
+        std::vector<std::shared_ptr<std::atomic<bool>>> cancelled;
+        // light that spilled into columns outside the batch
+        std::vector<LightEngine::BorderUpdate> outside;
+    };
+
+    struct MeshResult {
+        glm::ivec2 pos;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        std::vector<FinishedMesh> meshes;
+    };
+
+    World &_world;
+    WorldStorage &_storage;
+    const TerrainGenerator &_generator;
+    JobSystem &_jobs;
+    int _viewDistance;
+
+    std::unordered_map<glm::ivec2, Column, ColumnPosHash> _columns{};
+    glm::ivec2 _center{0, 0};
+    bool _hasCenter{false};
+    glm::vec3 _cameraPosition{0.0f};
+    glm::vec3 _cameraFront{0.0f, 0.0f, -1.0f};
+    glm::vec3 _sortedFront{0.0f, 0.0f, -1.0f};
+
+    // one queue per stage, most urgent at the back. entries can go stale and are checked when popped.
+    std::vector<glm::ivec2> _loadQueue{};
+    std::vector<glm::ivec2> _lightQueue{};
+    std::vector<glm::ivec2> _meshQueue{};
+    bool _queuesNeedSort{false};
+    unsigned int _jobsInFlight{0};
+    // updates that left the world alone because the workers were holding it
+    unsigned int _deferredInARow{0};
+    std::size_t _deferredUpdates{0};
+    bool _lightingInFlight{false};
+
+    LightEngine _light{};
+    LightEngine::ColumnPredicate _isLit;
+    std::vector<glm::ivec3> _changedBlocks{};
+    // edits next to a batch that is being lit, relit once the batch is done
+    std::vector<glm::ivec3> _deferredChanges{};
+
+    std::mutex _resultsMutex{};
+    std::vector<LoadResult> _loadResults{};
+    std::vector<LightResult> _lightResults{};
+    std::vector<MeshResult> _meshResults{};
+
+    // finished meshes waiting for their turn to be handed out
+    std::deque<FinishedMesh> _readyMeshes{};
+    // meshes of edited sections. they skip the queue and the budget.
+    std::vector<FinishedMesh> _editedMeshes{};
+    std::vector<glm::ivec3> _dirtySections{};
+    std::vector<glm::ivec3> _removedSections{};
+
+    // finished meshes come back here after they were uploaded, so mesh jobs rarely have to allocate
+    std::mutex _meshPoolMutex{};
+    std::vector<MeshData> _meshPool{};
+
+public:
+    ChunkStreamer(World &world, WorldStorage &storage, const TerrainGenerator &generator, JobSystem &jobs,
+        int viewDistance);
+    ~ChunkStreamer();
+    ChunkStreamer(const ChunkStreamer &other) = delete;
+    ChunkStreamer &operator=(const ChunkStreamer &other) = delete;
+
+    void update(const Camera &camera);
+
+    // moves at most budget finished meshes into out, in the order they finished, and returns how many.
+    // meshes of edited sections always come first and don't count towards the budget.
+    std::size_t takeMeshes(std::vector<FinishedMesh> &out, std::size_t budget);
+    // moves the positions of every section that was unloaded since the last call into out
+    void takeRemovedSections(std::vector<glm::ivec3> &out);
+    // hands a mesh's buffer back so a later mesh job can reuse it
+    void recycle(MeshData &&mesh);
+
+    std::size_t loadedColumnCount() const;
+    unsigned int jobsInFlight() const;
+    // updates since the start that put off applying results because the workers held the world
+    std::size_t deferredUpdates() const;
+
+private:
+    // these four need the world's mutex held exclusively
+    void collectResults();
+    void recenter(const glm::ivec2 &center);
+    void unloadColumn(const glm::ivec2 &pos, Column &column);
+    void relightChangedBlocks();
+
+    void dispatch();
+    // meshes what was taken from World::takeDirtySections, without the world's mutex held
+    void remeshDirtySections();
+
+    bool isLoaded(const glm::ivec2 &pos) const;
+    bool isLit(const glm::ivec2 &pos) const;
+    bool canLight(const glm::ivec2 &pos) const;
+    bool canMesh(const glm::ivec2 &pos) const;
+    // lower is more urgent
+    float priority(const glm::ivec2 &pos) const;
+
+    void loadJob(glm::ivec2 pos, std::shared_ptr<std::atomic<bool>> cancelled);
+    void lightJob(std::vector<glm::ivec2> columns, std::vector<std::shared_ptr<std::atomic<bool>>> cancelled,
+        std::unordered_set<glm::ivec2, ColumnPosHash> litNeighbours);
+    void meshJob(glm::ivec2 pos, std::shared_ptr<std::atomic<bool>> cancelled);
+    // leaves out empty if the section is missing or all air
+    void meshSection(Mesher &mesher, const glm::ivec3 &sectionPos, MeshData &out) const;
+    MeshData takePooledMesh();
+};
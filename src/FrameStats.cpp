@@ -0,0 +1,185 @@
+#include "FrameStats.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+namespace {
+    double milliseconds(double microseconds) {
+        return microseconds / 1000.0;
+    }
+
+    bool isJson(const std::string &path) {
+        const std::string extension = ".json";
+        return path.size() >= extension.size()
+            && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    void writeCsvRow(std::ostream &out, const std::string &window, const FrameStats::Summary &summary) {
+        for (std::size_t phase = 0; phase < FRAME_PHASE_COUNT; phase++) {
+            const FrameStats::PhaseSummary &stats = summary.phases[phase];
+            out << window << "," << summary.start << "," << summary.end << "," << FRAME_PHASE_NAMES[phase] << ","
+                << stats.count << "," << stats.mean << "," << stats.p50 << "," << stats.p95 << "," << stats.p99
+                << "," << stats.max;
+            // hitches are counted on whole frames only
+            for (std::uint64_t hitches : summary.hitches) {
+                out << ",";
+                if (phase == static_cast<std::size_t>(FramePhase::FRAME)) {
+                    out << hitches;
+                }
+            }
+            out << "\n";
+        }
+    }
+
+    void writeJsonSummary(std::ostream &out, const FrameStats::Summary &summary) {
+        out << "{\"start\": " << summary.start << ", \"end\": " << summary.end << ", \"phases\": {";
+        for (std::size_t phase = 0; phase < FRAME_PHASE_COUNT; phase++) {
+            const FrameStats::PhaseSummary &stats = summary.phases[phase];
+            out << (phase == 0 ? "" : ", ") << "\"" << FRAME_PHASE_NAMES[phase] << "\": {\"count\": " << stats.count
+                << ", \"mean_ms\": " << stats.mean << ", \"p50_ms\": " << stats.p50 << ", \"p95_ms\": " << stats.p95
+                << ", \"p99_ms\": " << stats.p99 << ", \"max_ms\": " << stats.max << "}";
+        }
+        out << "}, \"hitches\": [";
+        for (std::size_t i = 0; i < summary.hitches.size(); i++) {
+            out << (i == 0 ? "" : ", ") << summary.hitches[i];
+        }
+        out << "]}";
+    }
+}
+
+FrameStats::FrameStats(Config config)
+    : _config(std::move(config)),
+      _windowHitches(_config.hitchMilliseconds.size(), 0),
+      _sessionHitches(_config.hitchMilliseconds.size(), 0) {
+}
+
+void FrameStats::beginFrame(float deltaTime) {
+    Clock::time_point now = Clock::now();
+    _lap = now;
+    if (_firstFrame) {
+        _firstFrame = false;
+        _sessionStart = now;
+        _windowStart = now;
+        return;
+    }
+
+    record(FramePhase::FRAME, deltaTime);
+    double milliseconds = deltaTime * 1000.0;
+    for (std::size_t i = 0; i < _config.hitchMilliseconds.size(); i++) {
+        if (milliseconds > _config.hitchMilliseconds[i]) {
+            _windowHitches[i]++;
+        }
+    }
+    if (std::chrono::duration<double>(now - _windowStart).count() >= _config.windowSeconds) {
+        finishWindow();
+    }
+}
+
+void FrameStats::lap(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    if (!_firstFrame) {
+        record(phase, std::chrono::duration<double>(now - _lap).count());
+    }
+    _lap = now;
+}
+
+FrameStats::Summary FrameStats::finish() {
+    if (_window[static_cast<std::size_t>(FramePhase::FRAME)].count() > 0) {
+        finishWindow();
+    }
+    Summary session = summarize(_session, _sessionHitches, _sessionStart);
+    write(&session);
+    return session;
+}
+
+const FrameStats::Config &FrameStats::config() const {
+    return _config;
+}
+
+FrameStats::Summary FrameStats::window() const {
+    return summarize(_window, _windowHitches, _windowStart);
+}
+
+void FrameStats::record(FramePhase phase, double seconds) {
+    _window[static_cast<std::size_t>(phase)].record(static_cast<std::uint64_t>(std::llround(seconds * 1e6)));
+}
+
+FrameStats::Summary FrameStats::summarize(const std::array<Histogram, FRAME_PHASE_COUNT> &histograms,
+    const std::vector<std::uint64_t> &hitches, Clock::time_point start) const {
+    Summary summary;
+    summary.start = std::chrono::duration<double>(start - _sessionStart).count();
+    summary.end = std::chrono::duration<double>(Clock::now() - _sessionStart).count();
+    for (std::size_t phase = 0; phase < FRAME_PHASE_COUNT; phase++) {
+        const Histogram &histogram = histograms[phase];
+        PhaseSummary &stats = summary.phases[phase];
+        stats.count = histogram.count();
+        stats.mean = milliseconds(histogram.mean());
+        stats.p50 = milliseconds(static_cast<double>(histogram.percentile(50.0)));
+        stats.p95 = milliseconds(static_cast<double>(histogram.percentile(95.0)));
+        stats.p99 = milliseconds(static_cast<double>(histogram.percentile(99.0)));
+        stats.max = milliseconds(static_cast<double>(histogram.max()));
+    }
+    summary.hitches = hitches;
+    return summary;
+}
+
+void FrameStats::finishWindow() {
+    _windows.push_back(window());
+    for (std::size_t phase = 0; phase < FRAME_PHASE_COUNT; phase++) {
+        _session[phase].add(_window[phase]);
+        _window[phase].reset();
+    }
+    for (std::size_t i = 0; i < _windowHitches.size(); i++) {
+        _sessionHitches[i] += _windowHitches[i];
+        _windowHitches[i] = 0;
+    }
+    _windowStart = Clock::now();
+    write(nullptr);
+}
+
+void FrameStats::write(const Summary *session) {
+    if (_config.outputPath.empty() || _writeFailed) {
+        return;
+    }
+    std::ofstream out(_config.outputPath);
+    out << std::fixed << std::setprecision(3);
+    if (isJson(_config.outputPath)) {
+        out << "{\n  \"window_seconds\": " << _config.windowSeconds << ",\n  \"hitch_ms\": [";
+        for (std::size_t i = 0; i < _config.hitchMilliseconds.size(); i++) {
+            out << (i == 0 ? "" : ", ") << _config.hitchMilliseconds[i];
+        }
+        out << "],\n  \"windows\": [";
+        for (std::size_t i = 0; i < _windows.size(); i++) {
+            out << (i == 0 ? "\n    " : ",\n    ");
+            writeJsonSummary(out, _windows[i]);
+        }
+        out << "\n  ]";
+        if (session) {
+            out << ",\n  \"session\": ";
+            writeJsonSummary(out, *session);
+        }
+        out << "\n}\n";
+    } else {
+        out << "window,start_s,end_s,phase,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms";
+        for (double threshold : _config.hitchMilliseconds) {
+            out << ",over_" << threshold << "_ms";
+        }
+        out << "\n";
+        for (std::size_t i = 0; i < _windows.size(); i++) {
+            writeCsvRow(out, std::to_string(i), _windows[i]);
+        }
+        if (session) {
+            writeCsvRow(out, "session", *session);
+        }
+    }
+
+    // losing the stats isn't worth losing the game over, but there's no point in trying again every window
+    out.close();
+    if (!out) {
+        std::cerr << "Could not write frame stats to '" << _config.outputPath << "'" << std::endl;
+        _writeFailed = true;
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Histogram.h"
+
+// The top level parts of a frame, in the order they run.
+enum class FramePhase : std::uint8_t {
+    // from one frame to the next, waiting for vsync included. what the player sees.
+    FRAME,
+    INPUT,
+    UPDATE,
+    RENDER,
+    // swapping buffers and polling events
+    PRESENT
+};
+
+constexpr std::size_t FRAME_PHASE_COUNT = 5;
+
+constexpr const char *FRAME_PHASE_NAMES[FRAME_PHASE_COUNT] = {"frame", "input", "update", "render", "present"};
+
+// Collects how long every frame and each phase of it took into histograms, so stutters show up in p99 and
+// max instead of disappearing into an average. Frames over each hitch threshold are counted too.
+//
+// Stats are kept per window of windowSeconds, and for the whole session. Every finished window is added to
+// the output file, if there is one, which is rewritten each time so it's complete even if the game crashes.
+// It's CSV unless the file name ends in .json.
+class FrameStats {
+public:
+    struct Config {
+        double windowSeconds{10.0};
+        // frame times in milliseconds, 30 fps and worse
+        std::vector<double> hitchMilliseconds{1000.0 / 30.0, 50.0, 100.0, 250.0};
+        // empty to only collect
+        std::string outputPath{};
+    };
+
+    struct PhaseSummary {
+        std::uint64_t count{0};
+        // in milliseconds
+        double mean{0.0};
+        double p50{0.0};
+        double p95{0.0};
+        double p99{0.0};
+        double max{0.0};
+    };
+
+    struct Summary {
+        // seconds since the session started
+        double start{0.0};
+        double end{0.0};
+        std::array<PhaseSummary, FRAME_PHASE_COUNT> phases{};
+        // frames longer than each of the hitch thresholds
+        std::vector<std::uint64_t> hitches{};
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Config _config;
+    std::array<Histogram, FRAME_PHASE_COUNT> _window{};
+    std::array<Histogram, FRAME_PHASE_COUNT> _session{};
+    std::vector<std::uint64_t> _windowHitches{};
+    std::vector<std::uint64_t> _sessionHitches{};
+    std::vector<Summary> _windows{};
+    Clock::time_point _sessionStart{Clock::now()};
+    Clock::time_point _windowStart{_sessionStart};
+    Clock::time_point _lap{_sessionStart};
+    // the first frame's delta time includes loading, so it's left out
+    bool _firstFrame{true};
+    bool _writeFailed{false};
+
+public:
+    explicit FrameStats(Config config);
+
+    // records the time since the last frame, and starts timing the frame's phases
+    void beginFrame(float deltaTime);
+    // records the time since beginFrame or the last lap as the phase
+    void lap(FramePhase phase);
+    // finishes the current window, writes the output once more and returns the whole session
+    Summary finish();
+
+    const Config &config() const;
+    // of the window so far
+    Summary window() const;
+
+private:
+    void record(FramePhase phase, double seconds);
+    Summary summarize(const std::array<Histogram, FRAME_PHASE_COUNT> &histograms,
+        const std::vector<std::uint64_t> &hitches, Clock::time_point start) const;
+    void finishWindow();
+    // with the session at the end once it is finished
+    void write(const Summary *session);
+};
@@ -0,0 +1,32 @@
+#include "FrameUniforms.h"
+
+#include <glad/glad.h>
+
+#include "Camera.h"
+#include "GLState.h"
+
+FrameUniforms::FrameUniforms() {
+    glGenBuffers(1, &_buffer);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, _buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_STREAM_DRAW);
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBlock::FRAME), _buffer);
+}
+
+FrameUniforms::~FrameUniforms() {
+    GLState::deleteBuffers(1, &_buffer);
+}
+
+void FrameUniforms::update(const Camera &camera, float time, const Fog &fog) {
+    Data data{};
+    data.view = camera.viewMatrix();
+    data.projection = camera.projectionMatrix();
+    data.viewProjection = data.projection * data.view;
+    data.cameraPosition = glm::vec4(camera.position, time);
+    data.fogColor = glm::vec4(fog.color, 1.0f);
+    data.fogRange = glm::vec4(fog.start, fog.end, 0.0f, 0.0f);
+
+    // a new store every frame, so the driver doesn't wait for last frame's draws to finish reading the old one
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, _buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), &data, GL_STREAM_DRAW);
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBlock::FRAME), _buffer);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "Memory.h"
+#include "ShaderUniforms.h"
+
+struct Camera;
+
+// The Frame uniform block every world shader declares, filled in from the camera once a frame. The buffer
+// stays bound to UniformBlock::FRAME, and Shader points each program's block there when it's linked, so
+// no program has to be given the camera itself. Needs a current OpenGL context.
+class FrameUniforms {
+public:
+    struct Fog {
+        glm::vec3 color;
+        // distances from the camera, in blocks
+        float start;
+        float end;
+    };
+
+private:
+    // std140, has to match the block in the shaders
+    struct Data {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+        // w is the time
+        glm::vec4 cameraPosition;
+        glm::vec4 fogColor;
+        // x is start, y is end
+        glm::vec4 fogRange;
+    };
+    static_assert(sizeof(Data) == 3 * 64 + 3 * 16, "Data has to be laid out like the std140 Frame block");
+
+    unsigned int _buffer{0};
+    Memory::Allocation _gpuMemory{MemoryDomain::GPU, MemoryTag::RENDERING, sizeof(Data)};
+
+public:
+    FrameUniforms();
+    ~FrameUniforms();
+    FrameUniforms(const FrameUniforms &other) = delete;
+    FrameUniforms &operator=(const FrameUniforms &other) = delete;
+
+    // time is in seconds
+    void update(const Camera &camera, float time, const Fog &fog);
+};
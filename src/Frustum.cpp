@@ -0,0 +1,140 @@
+#include "Frustum.h"
+
+#include <glm/glm.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void BoxList::add(const glm::vec3 &min, const glm::vec3 &max) {
+    _minX.push_back(min.x);
+    _minY.push_back(min.y);
+    _minZ.push_back(min.z);
+    _maxX.push_back(max.x);
+    _maxY.push_back(max.y);
+    _maxZ.push_back(max.z);
+}
+
+void BoxList::set(std::size_t index, const glm::vec3 &min, const glm::vec3 &max) {
+    _minX[index] = min.x;
+    _minY[index] = min.y;
+    _minZ[index] = min.z;
+    _maxX[index] = max.x;
+    _maxY[index] = max.y;
+    _maxZ[index] = max.z;
+}
+
+void BoxList::swapRemove(std::size_t index) {
+    for (auto *values : {&_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ}) {
+        (*values)[index] = values->back();
+        values->pop_back();
+    }
+}
+
+void BoxList::clear() {
+    for (auto *values : {&_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ}) {
+        values->clear();
+    }
+}
+
+void BoxList::reserve(std::size_t count) {
+    for (auto *values : {&_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ}) {
+        values->reserve(count);
+    }
+}
+
+std::size_t BoxList::size() const {
+    return _minX.size();
+}
+
+glm::vec3 BoxList::min(std::size_t index) const {
+    return {_minX[index], _minY[index], _minZ[index]};
+}
+
+glm::vec3 BoxList::max(std::size_t index) const {
+    return {_maxX[index], _maxY[index], _maxZ[index]};
+}
+
+Frustum::Frustum(const glm::mat4 &viewProjection) {
+    // Gribb & Hartmann: each plane is the last row of the matrix plus or minus one of the others.
+    // glm matrices are column major, so m[column][row].
+    const glm::mat4 &m = viewProjection;
+    for (int i = 0; i < 3; i++) {
+        glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+        glm::vec4 last(m[0][3], m[1][3], m[2][3], m[3][3]);
+        _planes[i * 2] = last + row;
+        _planes[i * 2 + 1] = last - row;
+    }
+    for (auto &plane : _planes) {
+        plane = plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    }
+}
+
+const glm::vec4 &Frustum::plane(int index) const {
+    return _planes[index];
+}
+
+bool Frustum::intersects(const glm::vec3 &min, const glm::vec3 &max) const {
+    for (const auto &plane : _planes) {
+        // the corner furthest along the plane normal
+        glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+        if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t Frustum::cull(const BoxList &boxes, std::vector<std::uint32_t> &visible) const {
+    visible.clear();
+    const std::size_t count = boxes.size();
+
+    // the furthest corner only depends on the sign of the normal, so pick the arrays once per plane
+    // instead of once per box
+    const float *xs[6], *ys[6], *zs[6];
+    for (int p = 0; p < 6; p++) {
+        xs[p] = (_planes[p].x >= 0.0f ? boxes._maxX : boxes._minX).data();
+        ys[p] = (_planes[p].y >= 0.0f ? boxes._maxY : boxes._minY).data();
+        zs[p] = (_planes[p].z >= 0.0f ? boxes._maxZ : boxes._minZ).data();
+    }
+
+    std::size_t i = 0;
+#ifdef __SSE2__
+    __m128 normalX[6], normalY[6], normalZ[6], distance[6];
+    for (int p = 0; p < 6; p++) {
+        normalX[p] = _mm_set1_ps(_planes[p].x);
+        normalY[p] = _mm_set1_ps(_planes[p].y);
+        normalZ[p] = _mm_set1_ps(_planes[p].z);
+        distance[p] = _mm_set1_ps(_planes[p].w);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    // four boxes per iteration
+    for (; i + 4 <= count; i += 4) {
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(normalX[p], _mm_loadu_ps(xs[p] + i)), _mm_mul_ps(normalY[p], _mm_loadu_ps(ys[p] + i))),
+                _mm_add_ps(_mm_mul_ps(normalZ[p], _mm_loadu_ps(zs[p] + i)), distance[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+        }
+        int inside = ~_mm_movemask_ps(outside) & 0xF;
+        for (int lane = 0; inside != 0; lane++, inside >>= 1) {
+            if (inside & 1) {
+                visible.push_back(static_cast<std::uint32_t>(i + lane));
+            }
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) {
+            inside = _planes[p].x * xs[p][i] + _planes[p].y * ys[p][i] + _planes[p].z * zs[p][i] + _planes[p].w >= 0.0f;
+        }
+        if (inside) {
+            visible.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    return visible.size();
+}
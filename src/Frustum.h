@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+// Axis aligned boxes stored as a structure of arrays, so culling can test several boxes with each
+// instruction.
+class BoxList {
+private:
+    std::vector<float> _minX{}, _minY{}, _minZ{};
+    std::vector<float> _maxX{}, _maxY{}, _maxZ{};
+
+    friend class Frustum;
+
+public:
+    void add(const glm::vec3 &min, const glm::vec3 &max);
+    void set(std::size_t index, const glm::vec3 &min, const glm::vec3 &max);
+    // removes the box at index by moving the last box into its place
+    void swapRemove(std::size_t index);
+    void clear();
+    void reserve(std::size_t count);
+
+    std::size_t size() const;
+    glm::vec3 min(std::size_t index) const;
+    glm::vec3 max(std::size_t index) const;
+};
+
+class Frustum {
+private:
+    // ax + by + cz + d >= 0 for points inside, with (a, b, c) normalized. order: left, right, bottom,
+    // top, near, far.
+    glm::vec4 _planes[6];
+
+public:
+    // extracts the planes from a projection * view matrix
+    explicit Frustum(const glm::mat4 &viewProjection);
+
+    const glm::vec4 &plane(int index) const;
+
+    // conservative: boxes that straddle a plane count as visible
+    bool intersects(const glm::vec3 &min, const glm::vec3 &max) const;
+
+    // writes the indices of every box that intersects the frustum into visible, replacing its contents,
+    // and returns how many there are
+    std::size_t cull(const BoxList &boxes, std::vector<std::uint32_t> &visible) const;
+};
@@ -0,0 +1,29 @@
+#include "GLExtensions.h"
+
+#include <string>
+#include <unordered_set>
+
+namespace {
+    GLADloadproc currentLoader = nullptr;
+    std::unordered_set<std::string> extensions;
+}
+
+namespace GLExtensions {
+    void init(GLADloadproc loader) {
+        currentLoader = loader;
+        extensions.clear();
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            extensions.emplace(reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i))));
+        }
+    }
+
+    bool isSupported(const char *extension) {
+        return extensions.count(extension) > 0;
+    }
+
+    void *procAddress(const char *name) {
+        return currentLoader ? currentLoader(name) : nullptr;
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Finds extensions and the functions glad wasn't generated for. Whoever makes the context hands over its
+// function loader right after loading glad with it, so nothing else has to know about GLFW (or EGL).
+namespace GLExtensions {
+    void init(GLADloadproc loader);
+
+    bool isSupported(const char *extension);
+    // null if the loader doesn't know the function
+    void *procAddress(const char *name);
+}
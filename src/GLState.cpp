@@ -0,0 +1,288 @@
+#include "GLState.h"
+
+#include <array>
+
+namespace {
+    // nothing is known about a binding or setting set to this, so the next call always goes through
+    constexpr GLuint UNKNOWN = ~0u;
+    constexpr GLenum DRAW_INDIRECT_BUFFER = 0x8F3F;
+
+    enum class BufferTarget {
+        ARRAY,
+        COPY_READ,
+        COPY_WRITE,
+        PIXEL_UNPACK,
+        UNIFORM,
+        TEXTURE,
+        DRAW_INDIRECT,
+        COUNT
+    };
+
+    enum class TextureTarget {
+        TEXTURE_2D,
+        TEXTURE_2D_ARRAY,
+        TEXTURE_BUFFER,
+        COUNT
+    };
+
+    enum class Capability {
+        DEPTH_TEST,
+        BLEND,
+        CULL_FACE,
+        COUNT
+    };
+
+    struct State {
+        GLuint program;
+        GLuint vertexArray;
+        std::array<GLuint, static_cast<std::size_t>(BufferTarget::COUNT)> buffers;
+        std::array<GLuint, GLState::UNIFORM_BUFFER_BINDINGS> uniformBuffers;
+        GLuint activeTexture;
+        std::array<std::array<GLuint, static_cast<std::size_t>(TextureTarget::COUNT)>, GLState::TEXTURE_UNITS> textures;
+        // UNKNOWN, GL_FALSE or GL_TRUE
+        std::array<GLuint, static_cast<std::size_t>(Capability::COUNT)> capabilities;
+        GLenum blendSource;
+        GLenum blendDestination;
+        GLenum depthFunction;
+        // UNKNOWN, GL_FALSE or GL_TRUE
+        GLuint depthMask;
+        GLenum cullFace;
+        std::array<GLint, 4> viewport;
+    };
+
+    State unknownState() {
+        State unknown{};
+        unknown.program = UNKNOWN;
+        unknown.vertexArray = UNKNOWN;
+        unknown.buffers.fill(UNKNOWN);
+        unknown.uniformBuffers.fill(UNKNOWN);
+        unknown.activeTexture = UNKNOWN;
+        for (auto &unit : unknown.textures) {
+            unit.fill(UNKNOWN);
+        }
+        unknown.capabilities.fill(UNKNOWN);
+        unknown.blendSource = UNKNOWN;
+        unknown.blendDestination = UNKNOWN;
+        unknown.depthFunction = UNKNOWN;
+        unknown.depthMask = UNKNOWN;
+        unknown.cullFace = UNKNOWN;
+        unknown.viewport.fill(-1);
+        return unknown;
+    }
+
+    State state = unknownState();
+    GLState::Counters callCounters;
+
+    // COUNT for targets that aren't tracked
+    BufferTarget bufferTarget(GLenum target) {
+        switch (target) {
+            case GL_ARRAY_BUFFER: return BufferTarget::ARRAY;
+            case GL_COPY_READ_BUFFER: return BufferTarget::COPY_READ;
+            case GL_COPY_WRITE_BUFFER: return BufferTarget::COPY_WRITE;
+            case GL_PIXEL_UNPACK_BUFFER: return BufferTarget::PIXEL_UNPACK;
+            case GL_UNIFORM_BUFFER: return BufferTarget::UNIFORM;
+            case GL_TEXTURE_BUFFER: return BufferTarget::TEXTURE;
+            case DRAW_INDIRECT_BUFFER: return BufferTarget::DRAW_INDIRECT;
+            default: return BufferTarget::COUNT;
+        }
+    }
+
+    TextureTarget textureTarget(GLenum target) {
+        switch (target) {
+            case GL_TEXTURE_2D: return TextureTarget::TEXTURE_2D;
+            case GL_TEXTURE_2D_ARRAY: return TextureTarget::TEXTURE_2D_ARRAY;
+            case GL_TEXTURE_BUFFER: return TextureTarget::TEXTURE_BUFFER;
+            default: return TextureTarget::COUNT;
+        }
+    }
+
+    Capability capability(GLenum capability) {
+        switch (capability) {
+            case GL_DEPTH_TEST: return Capability::DEPTH_TEST;
+            case GL_BLEND: return Capability::BLEND;
+            case GL_CULL_FACE: return Capability::CULL_FACE;
+            default: return Capability::COUNT;
+        }
+    }
+
+    // records a call, and returns true if it has to be issued because it changes value
+    template <typename T>
+    bool change(T &value, T newValue) {
+        if (value == newValue) {
+            callCounters.skipped++;
+            return false;
+        }
+        value = newValue;
+        callCounters.issued++;
+        return true;
+    }
+
+    // what GL does to the bindings of a deleted object
+    void forget(GLuint &binding, GLuint object) {
+        if (binding == object) {
+            binding = 0;
+        }
+    }
+}
+
+void GLState::useProgram(GLuint program) {
+    if (change(state.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GLState::bindVertexArray(GLuint vertexArray) {
+    if (change(state.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer) {
+    BufferTarget tracked = bufferTarget(target);
+    if (tracked == BufferTarget::COUNT) {
+        callCounters.issued++;
+        glBindBuffer(target, buffer);
+    } else if (change(state.buffers[static_cast<std::size_t>(tracked)], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    BufferTarget tracked = bufferTarget(target);
+    if (tracked == BufferTarget::UNIFORM && index < UNIFORM_BUFFER_BINDINGS) {
+        if (change(state.uniformBuffers[index], buffer)) {
+            glBindBufferBase(target, index, buffer);
+            state.buffers[static_cast<std::size_t>(tracked)] = buffer;
+        }
+        return;
+    }
+    callCounters.issued++;
+    glBindBufferBase(target, index, buffer);
+    if (tracked != BufferTarget::COUNT) {
+        state.buffers[static_cast<std::size_t>(tracked)] = buffer;
+    }
+}
+
+void GLState::bindTexture(unsigned int unit, GLenum target, GLuint texture) {
+    TextureTarget tracked = textureTarget(target);
+    if (unit >= TEXTURE_UNITS || tracked == TextureTarget::COUNT) {
+        callCounters.issued += 2;
+        state.activeTexture = UNKNOWN;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        return;
+    }
+    GLuint &binding = state.textures[unit][static_cast<std::size_t>(tracked)];
+    if (binding == texture) {
+        callCounters.skipped++;
+        return;
+    }
+    if (change(state.activeTexture, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    binding = texture;
+    callCounters.issued++;
+    glBindTexture(target, texture);
+}
+
+void GLState::setEnabled(GLenum capabilityName, bool enabled) {
+    Capability tracked = capability(capabilityName);
+    if (tracked == Capability::COUNT) {
+        callCounters.issued++;
+    } else if (!change(state.capabilities[static_cast<std::size_t>(tracked)], static_cast<GLuint>(enabled))) {
+        return;
+    }
+    if (enabled) {
+        glEnable(capabilityName);
+    } else {
+        glDisable(capabilityName);
+    }
+}
+
+void GLState::blendFunc(GLenum source, GLenum destination) {
+    if (state.blendSource == source && state.blendDestination == destination) {
+        callCounters.skipped++;
+        return;
+    }
+    state.blendSource = source;
+    state.blendDestination = destination;
+    callCounters.issued++;
+    glBlendFunc(source, destination);
+}
+
+void GLState::depthFunc(GLenum function) {
+    if (change(state.depthFunction, function)) {
+        glDepthFunc(function);
+    }
+}
+
+void GLState::depthMask(bool enabled) {
+    if (change(state.depthMask, static_cast<GLuint>(enabled))) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void GLState::cullFace(GLenum face) {
+    if (change(state.cullFace, face)) {
+        glCullFace(face);
+    }
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (change(state.viewport, {x, y, width, height})) {
+        glViewport(x, y, width, height);
+    }
+}
+
+void GLState::deleteProgram(GLuint program) {
+    forget(state.program, program);
+    glDeleteProgram(program);
+}
+
+void GLState::deleteVertexArrays(GLsizei count, const GLuint *vertexArrays) {
+    for (GLsizei i = 0; i < count; i++) {
+        forget(state.vertexArray, vertexArrays[i]);
+    }
+    glDeleteVertexArrays(count, vertexArrays);
+}
+
+void GLState::deleteBuffers(GLsizei count, const GLuint *buffers) {
+    for (GLsizei i = 0; i < count; i++) {
+        if (buffers[i] == 0) {
+            continue;
+        }
+        for (auto &binding : state.buffers) {
+            forget(binding, buffers[i]);
+        }
+        for (auto &binding : state.uniformBuffers) {
+            forget(binding, buffers[i]);
+        }
+    }
+    glDeleteBuffers(count, buffers);
+}
+
+void GLState::deleteTextures(GLsizei count, const GLuint *textures) {
+    for (GLsizei i = 0; i < count; i++) {
+        if (textures[i] == 0) {
+            continue;
+        }
+        for (auto &unit : state.textures) {
+            for (auto &binding : unit) {
+                forget(binding, textures[i]);
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+void GLState::invalidate() {
+    state = unknownState();
+}
+
+const GLState::Counters &GLState::counters() {
+    return callCounters;
+}
+
+void GLState::resetCounters() {
+    callCounters = {};
+}
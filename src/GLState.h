@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// Shadows the GL state the game changes and drops calls that wouldn't change anything. Everything that binds
+// or toggles something GLState knows about has to go through it, or the shadow goes stale. Deleting objects
+// has to go through it too, since GL unbinds them. Only for the thread with the current context.
+//
+// Nothing is unbound after use: whoever needs something bound (or needs nothing bound, like a client memory
+// upload with GL_PIXEL_UNPACK_BUFFER) binds it, and the tracker skips it if it already is.
+namespace GLState {
+    // enough for every unit the game uses
+    constexpr unsigned int TEXTURE_UNITS = 16;
+    constexpr unsigned int UNIFORM_BUFFER_BINDINGS = 16;
+
+    struct Counters {
+        // calls that reached GL
+        std::size_t issued{0};
+        // calls that were dropped because they wouldn't have changed anything
+        std::size_t skipped{0};
+    };
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    // GL_ELEMENT_ARRAY_BUFFER belongs to the bound vertex array, so it's passed straight through
+    void bindBuffer(GLenum target, GLuint buffer);
+    // also binds the buffer to target itself, like GL does
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    // makes unit active first if the texture isn't bound there already
+    void bindTexture(unsigned int unit, GLenum target, GLuint texture);
+
+    // only for GL_DEPTH_TEST, GL_BLEND and GL_CULL_FACE
+    void setEnabled(GLenum capability, bool enabled);
+    void blendFunc(GLenum source, GLenum destination);
+    void depthFunc(GLenum function);
+    void depthMask(bool enabled);
+    void cullFace(GLenum face);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    void deleteProgram(GLuint program);
+    void deleteVertexArrays(GLsizei count, const GLuint *vertexArrays);
+    void deleteBuffers(GLsizei count, const GLuint *buffers);
+    void deleteTextures(GLsizei count, const GLuint *textures);
+
+    // forgets everything, for when something else may have changed the state
+    void invalidate();
+
+    // since the last resetCounters, which is meant to be called once a frame
+    const Counters &counters();
+    void resetCounters();
+}
@@ -1,18 +1,290 @@
 #include "Game.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <utility>
 #include "Window.h"
 #include "Input.h"
+#include "Memory.h"
+#include "Profiler.h"
+#include "Raycast.h"
+
+Game::Game() :
+    _camera(glm::vec3(0.0f, TerrainGenerator::SEA_LEVEL + 24.0f, 0.0f)),
+    _generator(WORLD_SEED),
+    _storage("saves/world"),
+    _resources("resources", "cache/programs"),
+    // _jobs isn't constructed yet, but it will have the default number of workers
+    _renderQueue(JobSystem::defaultWorkerCount()),
+    _streamer(_world, _storage, _generator, _jobs, VIEW_DISTANCE) {
+    // a little past the corners of the loaded area
+    _camera.farPlane = VIEW_DISTANCE * ChunkSection::SIZE * 1.5f;
+    // in blocks per second, fast enough to cross fresh terrain quickly
+    _camera.movementSpeed = 40.0f;
+    Memory::setBudget(MemoryDomain::CPU, MemoryTag::CHUNKS, CHUNK_MEMORY_BUDGET);
+    Memory::setBudget(MemoryDomain::CPU, MemoryTag::LIGHT, LIGHT_MEMORY_BUDGET);
+    Memory::setBudget(MemoryDomain::GPU, MemoryTag::MESHES, MESH_GPU_MEMORY_BUDGET);
+    Memory::setBudget(MemoryDomain::GPU, MemoryTag::TEXTURES, TEXTURE_GPU_MEMORY_BUDGET);
+
+    auto start = std::chrono::steady_clock::now();
+    _resources.loadShader("chunk", "vertex", "fragment");
+    auto shadersDone = std::chrono::steady_clock::now();
+    _shaderSeconds = std::chrono::duration<double>(shadersDone - start).count();
+
+    // the real block textures show up a few frames later, see update
+    std::vector<std::string> blockTextures;
+    for (std::uint16_t texture = 0; texture < BlockTextures::COUNT; texture++) {
+        blockTextures.emplace_back(BlockTextures::name(texture));
+    }
+    _resources.loadTextureArray("blocks", "textures/blocks", blockTextures, _jobs);
+    _textureSetupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shadersDone).count();
+    glClearColor(FOG_COLOR.x, FOG_COLOR.y, FOG_COLOR.z, 1.0f);
+}
+
+Game::~Game() {
+    saveModifiedColumns();
+    reportMemory();
+    if (Profiler::isCapturing()) {
+        writeTrace();
+    }
+}
 
 void Game::processInput(Window &window, float deltaTime) {
-    if (window.input().isKeyPressed(GLFW_KEY_ESCAPE)) {
+    Profiler::Zone zone("Game::processInput");
+    _frameStart = std::chrono::steady_clock::now();
+    _statusTimer += deltaTime;
+    if (_statusTimer >= STATUS_INTERVAL) {
+        window.setStatus(frameStatus());
+        _statusTimer = 0.0f;
+        _statusFrames = 0;
+        _statusCpuSeconds = 0.0;
+    }
+
+    const Input &input = window.input();
+    if (input.isKeyPressed(GLFW_KEY_ESCAPE)) {
         window.setShouldClose(true);
     }
-    _camera.processInput(window, deltaTime);
+    if (window.height() > 0) {
+        _camera.aspectRatio = static_cast<float>(window.width()) / static_cast<float>(window.height());
+    }
+    float forward = (input.isKeyPressed(GLFW_KEY_W) ? 1.0f : 0.0f) - (input.isKeyPressed(GLFW_KEY_S) ? 1.0f : 0.0f);
+    float sideways = (input.isKeyPressed(GLFW_KEY_D) ? 1.0f : 0.0f) - (input.isKeyPressed(GLFW_KEY_A) ? 1.0f : 0.0f);
+    _camera.move(forward, sideways, deltaTime);
+    _camera.turn(input.mouseOffset());
+
+    bool breaking = input.isMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT);
+    bool placing = input.isMouseButtonPressed(GLFW_MOUSE_BUTTON_RIGHT);
+    if (breaking && !_wasBreaking) {
+        editTargetedBlock(true);
+    } else if (placing && !_wasPlacing) {
+        editTargetedBlock(false);
+    }
+    _wasBreaking = breaking;
+    _wasPlacing = placing;
+
+    bool togglingTrace = input.isKeyPressed(GLFW_KEY_F3);
+    if (togglingTrace && !_wasTogglingTrace) {
+        toggleTrace();
+    }
+    _wasTogglingTrace = togglingTrace;
 }
 
 void Game::update(float deltaTime) {
+    Profiler::Zone zone("Game::update");
+    _time += deltaTime;
+    if (!_texturesLoaded) {
+        _texturesLoaded = _resources.uploadTextures(TEXTURE_UPLOAD_BUDGET);
+        if (_texturesLoaded) {
+            reportStartup();
+        }
+    }
+    _streamer.update(_camera);
+
+    _streamer.takeRemovedSections(_removedSections);
+    for (const auto &sectionPos : _removedSections) {
+        _chunkRenderer.remove(sectionPos);
+    }
+    _removedSections.clear();
 
+    _streamer.takeMeshes(_finishedMeshes, MESH_UPLOADS_PER_FRAME);
+    for (auto &finished : _finishedMeshes) {
+        _chunkRenderer.upload(finished.sectionPos, finished.mesh);
+        _streamer.recycle(std::move(finished.mesh));
+    }
+    _finishedMeshes.clear();
+
+    _uploadReportTimer += deltaTime;
+    if (_uploadReportTimer >= UPLOAD_REPORT_INTERVAL) {
+        reportUploads();
+        reportMemory();
+        _uploadReportTimer = 0.0f;
+    }
 }
 
 void Game::render() {
+    Profiler::Zone zone("Game::render");
+    _gpuTimer.beginFrame();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    float fogEnd = VIEW_DISTANCE * ChunkSection::SIZE;
+    _frameUniforms.update(_camera, _time, {FOG_COLOR, fogEnd * FOG_START, fogEnd});
+
+    _resources.getTextureArray("blocks").bind(Shaders::textureUnit(Uniform::BLOCKS));
+    _chunkRenderer.submit(_renderQueue, _resources.getShader("chunk"), _camera, _jobs);
+    _renderQueue.sort();
+    _renderQueue.execute(&_gpuTimer);
+    _gpuTimer.endFrame();
+
+    _glCalls = GLState::counters();
+    GLState::resetCounters();
+    _statusCpuSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - _frameStart).count();
+    _statusFrames++;
+}
+
+void Game::toggleTrace() {
+    if (Profiler::isCapturing()) {
+        writeTrace();
+    } else {
+        Profiler::start();
+        std::cout << "Started trace capture, press F3 again to stop" << std::endl;
+    }
+}
+
+World &Game::world() {
+    return _world;
+}
 
-}
\ No newline at end of file
+const World &Game::world() const {
+    return _world;
+}
+
+JobSystem &Game::jobs() {
+    return _jobs;
+}
+
+void Game::editTargetedBlock(bool breaking) {
+    std::unique_lock<std::shared_mutex> lock(_world.mutex());
+    Raycast::Hit target = Raycast::cast(_world, {_camera.position, _camera.front, REACH});
+    if (!target.hit) {
+        return;
+    }
+    if (breaking) {
+        _world.setBlock(target.pos, Blocks::AIR);
+        return;
+    }
+    // against the top or bottom face of the world there's nowhere to put it
+    glm::ivec3 placed = target.pos + Raycast::normal(target.face);
+    if (placed.y >= 0 && placed.y < World::HEIGHT) {
+        _world.setBlock(placed, PLACED_BLOCK);
+    }
+}
+
+void Game::reportUploads() {
+    const ChunkRenderer::UploadStats &stats = _chunkRenderer.uploadStats();
+    if (stats.meshes == 0) {
+        return;
+    }
+    double megabytes = static_cast<double>(stats.bytes) / (1024.0 * 1024.0);
+    std::cout << "Uploaded " << stats.meshes << " meshes (" << megabytes << " MiB) at "
+        << megabytes / stats.seconds << " MiB/s, " << stats.directUploads << " without the stream buffer"
+        << std::endl;
+    _chunkRenderer.resetUploadStats();
+
+    ChunkRenderer::GeometryStats geometry = _chunkRenderer.geometryStats();
+    std::cout << "Chunk geometry: " << geometry.pages << " pages, "
+        << geometry.vertexBytes / (1024 * 1024) << " of " << geometry.capacityBytes / (1024 * 1024) << " MiB used, "
+        << geometry.freeRanges << " free ranges, fragmentation " << geometry.fragmentation << ", "
+        << geometry.compactions << " compactions, " << _chunkRenderer.drawCallCount() << " draw calls for "
+        << _chunkRenderer.visibleCount() << " sections" << std::endl;
+    const RenderQueue::Stats &queue = _renderQueue.stats();
+    std::cout << "Render queue: " << queue.packets << " packets in " << queue.runs << " runs, "
+        << queue.sortPasses << " radix sort passes" << std::endl;
+    std::cout << "GL state changes last frame: " << _glCalls.issued << " issued, " << _glCalls.skipped << " skipped"
+        << std::endl;
+    const GpuTimer::Stats &gpu = _gpuTimer.stats();
+    std::cout << "GPU timer: " << gpu.frames << " frames timed, " << gpu.lostFrames << " came back too late, "
+        << gpu.droppedZones << " zones dropped" << std::endl;
+}
+
+void Game::reportStartup() {
+    const ResourceManager::TextureLoadStats &textures = _resources.textureLoadStats();
+    std::cout << "Startup: shaders " << _shaderSeconds * 1000.0 << " ms, texture setup "
+        << _textureSetupSeconds * 1000.0 << " ms, " << textures.layers << " textures ("
+        << textures.bytes / 1024 << " KiB) decoded in " << textures.decodeSeconds * 1000.0 << " ms of worker time, "
+        << "uploaded in " << textures.uploadSeconds * 1000.0 << " ms over " << textures.uploadCalls << " frames ("
+        << textures.directUploads << " without the stream buffer), all textures in after "
+        << textures.seconds * 1000.0 << " ms" << std::endl;
+}
+
+void Game::reportMemory() {
+    MemoryReport report = Memory::report();
+    std::cout << "Memory by tag, with the peaks since the game started:\n" << report << std::flush;
+    WorldMemoryReport world;
+    {
+        // the streamer's jobs may be reading it
+        std::shared_lock<std::shared_mutex> lock(_world.mutex());
+        world = _world.memoryReport();
+    }
+    std::cout << "World: " << world << std::flush;
+    for (std::size_t domain = 0; domain < MEMORY_DOMAIN_COUNT; domain++) {
+        for (std::size_t tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+            if (report.usage[domain][tag].isOverBudget()) {
+                std::cerr << MEMORY_DOMAIN_NAMES[domain] << " " << MEMORY_TAG_NAMES[tag] << " memory is over budget"
+                    << std::endl;
+            }
+        }
+    }
+}
+
+std::string Game::frameStatus() const {
+    int frames = std::max(_statusFrames, 1);
+    std::ostringstream status;
+    status << std::fixed << std::setprecision(2) << "frame " << _statusTimer * 1000.0f / frames << " ms, cpu "
+        << _statusCpuSeconds * 1000.0 / frames << " ms";
+    // the first result is the whole frame, the rest are passes
+    const auto &gpu = _gpuTimer.results();
+    if (gpu.empty()) {
+        return status.str();
+    }
+    status << ", gpu " << gpu[0].milliseconds << " ms";
+    for (std::size_t i = 1; i < gpu.size(); i++) {
+        status << (i == 1 ? " (" : ", ") << gpu[i].name << " " << gpu[i].milliseconds;
+    }
+    if (gpu.size() > 1) {
+        status << ")";
+    }
+    return status.str();
+}
+
+void Game::saveModifiedColumns() {
+    std::unique_lock<std::shared_mutex> lock(_world.mutex());
+    for (const auto &column : _world.modifiedColumns()) {
+        _storage.saveColumn(column.x, column.y, _world.getColumn(column.x, column.y));
+        _world.clearModified(column.x, column.y);
+    }
+}
+
+void Game::writeTrace() {
+    Profiler::stop();
+    std::time_t now = std::time(nullptr);
+    std::ostringstream path;
+    path << TRACE_DIRECTORY << "/trace-" << std::put_time(std::localtime(&now), "%Y%m%d-%H%M%S") << ".json";
+    // a trace that can't be written isn't worth losing the game over
+    try {
+        std::filesystem::create_directories(TRACE_DIRECTORY);
+        Profiler::TraceStats stats = Profiler::writeChromeTrace(path.str());
+        std::cout << "Wrote " << stats.events << " zones on " << stats.tracks << " tracks to " << path.str();
+        if (stats.dropped > 0) {
+            std::cout << " (" << stats.dropped << " dropped, tracks were full)";
+        }
+        std::cout << std::endl;
+    } catch (const std::exception &exception) {
+        std::cerr << exception.what() << std::endl;
+    }
+}
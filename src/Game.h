@@ -1,17 +1,109 @@
 #pragma once
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 #include "Camera.h"
+#include "ChunkRenderer.h"
+#include "ChunkStreamer.h"
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
+#include "RenderQueue.h"
+#include "ResourceManager.h"
+#include "TerrainGenerator.h"
+#include "World.h"
+#include "WorldStorage.h"
 
 class Window;
 
 class Game {
+public:
+    static constexpr int WORLD_SEED = 1337;
+    // in chunks
+    static constexpr int VIEW_DISTANCE = 32;
+    // uploading is the only streaming work left on the main thread, so it is capped to keep frames short.
+    // uploads go through the renderer's stream buffer, so this many only costs a few copies.
+    static constexpr std::size_t MESH_UPLOADS_PER_FRAME = 256;
+    // decoded textures uploaded a frame, in bytes, while they're still coming in
+    static constexpr std::size_t TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024;
+    // seconds between upload bandwidth reports
+    static constexpr float UPLOAD_REPORT_INTERVAL = 5.0f;
+    // seconds between frame time updates in the title bar
+    static constexpr float STATUS_INTERVAL = 0.5f;
+    // how far away blocks can be broken and placed, in blocks
+    static constexpr float REACH = 8.0f;
+    static constexpr BlockId PLACED_BLOCK = Blocks::TORCH;
+    // also the clear color, so the far terrain fades into the sky
+    inline static const glm::vec3 FOG_COLOR{0.3f, 0.3f, 0.3f};
+    // how far into the view distance fog starts
+    static constexpr float FOG_START = 0.6f;
+    // generous for VIEW_DISTANCE, going over one means something leaks or grew a lot. see Memory::setBudget.
+    static constexpr std::size_t CHUNK_MEMORY_BUDGET = 512 * 1024 * 1024;
+    static constexpr std::size_t LIGHT_MEMORY_BUDGET = 512 * 1024 * 1024;
+    static constexpr std::size_t MESH_GPU_MEMORY_BUDGET = 1024 * 1024 * 1024;
+    static constexpr std::size_t TEXTURE_GPU_MEMORY_BUDGET = 256 * 1024 * 1024;
+    // profiler captures are written here, see toggleTrace
+    static constexpr const char *TRACE_DIRECTORY = "traces";
+
 private:
     Camera _camera;
+    World _world;
+    TerrainGenerator _generator;
+    WorldStorage _storage;
+    ResourceManager _resources;
+    ChunkRenderer _chunkRenderer;
+    FrameUniforms _frameUniforms;
+    RenderQueue _renderQueue;
+    GpuTimer _gpuTimer;
+    ChunkStreamer _streamer;
+    std::vector<ChunkStreamer::FinishedMesh> _finishedMeshes{};
+    std::vector<glm::ivec3> _removedSections{};
+    // blocks are edited once per click, not every frame a button is held
+    bool _wasBreaking{false};
+    bool _wasPlacing{false};
+    bool _wasTogglingTrace{false};
+    float _uploadReportTimer{0.0f};
+    // frame times since the title bar was last updated. cpu time is processInput through render.
+    float _statusTimer{0.0f};
+    int _statusFrames{0};
+    double _statusCpuSeconds{0.0};
+    std::chrono::steady_clock::time_point _frameStart{};
+    // seconds since the game started
+    float _time{0.0f};
+    bool _texturesLoaded{false};
+    // how long the constructor spent on each part of loading resources, see reportStartup
+    double _shaderSeconds{0.0};
+    double _textureSetupSeconds{0.0};
+    // GL calls made and dropped during the last whole frame
+    GLState::Counters _glCalls{};
+    // declared after the world and the streamer so running jobs are finished before they go away
+    JobSystem _jobs;
 
 public:
+    Game();
+    ~Game();
+    Game(const Game &other) = delete;
+    Game &operator=(const Game &other) = delete;
+
     void processInput(Window &input, float deltaTime);
     void update(float deltaTime);
     void render();
-};
+    // starts a profiler capture, or stops the running one and writes it to TRACE_DIRECTORY. bound to F3.
+    void toggleTrace();
 
+    World &world();
+    const World &world() const;
+    JobSystem &jobs();
 
+private:
+    void editTargetedBlock(bool breaking);
+    void reportUploads();
+    void reportStartup();
+    void reportMemory();
+    std::string frameStatus() const;
+    void saveModifiedColumns();
+    void writeTrace();
+};
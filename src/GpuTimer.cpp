@@ -0,0 +1,99 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer() : _track(Profiler::createTrack("GPU")) {
+    glGenQueries(static_cast<GLsizei>(_queries.size()), _queries.data());
+    for (auto &frame : _frames) {
+        frame.names.reserve(MAX_ZONES);
+    }
+}
+
+GpuTimer::~GpuTimer() {
+    glDeleteQueries(static_cast<GLsizei>(_queries.size()), _queries.data());
+}
+
+void GpuTimer::beginFrame() {
+    _frame = (_frame + 1) % FRAME_LATENCY;
+    collect(_frame);
+
+    Frame &frame = _frames[_frame];
+    frame.names.clear();
+    frame.open.clear();
+    glGetInteger64v(GL_TIMESTAMP, &frame.gpuTime);
+    frame.traced = Profiler::isCapturing();
+    frame.cpuTime = frame.traced ? Profiler::now() : 0;
+    begin("frame");
+}
+
+void GpuTimer::endFrame() {
+    Frame &frame = _frames[_frame];
+    while (!frame.open.empty()) {
+        end();
+    }
+    frame.pending = true;
+}
+
+void GpuTimer::begin(const char *name) {
+    Frame &frame = _frames[_frame];
+    if (frame.names.size() == MAX_ZONES) {
+        frame.open.push_back(-1);
+        _stats.droppedZones++;
+        return;
+    }
+    auto zone = static_cast<int>(frame.names.size());
+    frame.names.push_back(name);
+    frame.open.push_back(zone);
+    glQueryCounter(query(_frame, zone, false), GL_TIMESTAMP);
+}
+
+void GpuTimer::end() {
+    Frame &frame = _frames[_frame];
+    int zone = frame.open.back();
+    frame.open.pop_back();
+    if (zone >= 0) {
+        glQueryCounter(query(_frame, zone, true), GL_TIMESTAMP);
+    }
+}
+
+const std::vector<GpuTimer::Result> &GpuTimer::results() const {
+    return _results;
+}
+
+const GpuTimer::Stats &GpuTimer::stats() const {
+    return _stats;
+}
+
+GLuint GpuTimer::query(std::size_t frame, std::size_t zone, bool end) const {
+    return _queries[(frame * MAX_ZONES + zone) * 2 + (end ? 1 : 0)];
+}
+
+void GpuTimer::collect(std::size_t frameIndex) {
+    Frame &frame = _frames[frameIndex];
+    if (!frame.pending) {
+        return;
+    }
+    frame.pending = false;
+
+    // the frame zone ends last, so once it's there the rest are too
+    GLint available = 0;
+    glGetQueryObjectiv(query(frameIndex, 0, true), GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        _stats.lostFrames++;
+        return;
+    }
+
+    bool traced = frame.traced && Profiler::isCapturing();
+    _results.clear();
+    for (std::size_t zone = 0; zone < frame.names.size(); zone++) {
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(query(frameIndex, zone, false), GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(query(frameIndex, zone, true), GL_QUERY_RESULT, &end);
+        _results.push_back({frame.names[zone], static_cast<double>(end - start) / 1e6});
+        if (traced) {
+            auto offset = frame.cpuTime - frame.gpuTime;
+            Profiler::record(_track, frame.names[zone], static_cast<std::int64_t>(start) + offset,
+                static_cast<std::int64_t>(end) + offset);
+        }
+    }
+    _stats.frames++;
+}
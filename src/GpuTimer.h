@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "Profiler.h"
+
+// Times stretches of GPU work with GL_TIMESTAMP queries. Each frame has its own set of queries out of a ring
+// of FRAME_LATENCY, and a frame's results are only read back when its queries come up for reuse, by which
+// time the GPU is long done with them. So reading them never stalls.
+//
+// While the profiler is capturing, the zones also go to a "GPU" track of the trace, shifted onto the CPU's
+// clock. Needs a current OpenGL context.
+class GpuTimer {
+public:
+    static constexpr std::size_t FRAME_LATENCY = 4;
+    // a frame, including the zone beginFrame opens
+    static constexpr std::size_t MAX_ZONES = 32;
+
+    struct Result {
+        const char *name;
+        double milliseconds;
+    };
+
+    struct Stats {
+        std::size_t frames{0};
+        // frames whose results still weren't there when their queries had to be reused
+        std::size_t lostFrames{0};
+        // zones begun after a frame already had MAX_ZONES
+        std::size_t droppedZones{0};
+    };
+
+private:
+    struct Frame {
+        // of every zone, in the order they began. zone i uses queries 2i and 2i + 1.
+        std::vector<const char *> names{};
+        // zones that were begun but not ended yet, -1 for dropped ones
+        std::vector<int> open{};
+        // the same moment on the GPU's clock and on the profiler's, taken in beginFrame
+        GLint64 gpuTime{0};
+        std::int64_t cpuTime{0};
+        bool traced{false};
+        bool pending{false};
+    };
+
+    std::array<GLuint, FRAME_LATENCY * MAX_ZONES * 2> _queries{};
+    std::array<Frame, FRAME_LATENCY> _frames{};
+    std::size_t _frame{0};
+    std::vector<Result> _results{};
+    Stats _stats{};
+    Profiler::Track &_track;
+
+public:
+    GpuTimer();
+    ~GpuTimer();
+    GpuTimer(const GpuTimer &other) = delete;
+    GpuTimer &operator=(const GpuTimer &other) = delete;
+
+    // picks up the results of the frame FRAME_LATENCY frames ago, then opens a "frame" zone around
+    // everything up to endFrame
+    void beginFrame();
+    void endFrame();
+    // zones can nest. name should be a string literal.
+    void begin(const char *name);
+    void end();
+
+    // zones of the newest frame that came back, the whole frame first
+    const std::vector<Result> &results() const;
+    const Stats &stats() const;
+
+private:
+    GLuint query(std::size_t frame, std::size_t zone, bool end) const;
+    void collect(std::size_t frameIndex);
+};
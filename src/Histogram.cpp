@@ -0,0 +1,90 @@
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Histogram::record(std::uint64_t microseconds) {
+    _counts[bucketIndex(std::min(microseconds, HIGHEST_VALUE))]++;
+    _min = _count == 0 ? microseconds : std::min(_min, microseconds);
+    _max = std::max(_max, microseconds);
+    _sum += microseconds;
+    _count++;
+}
+
+void Histogram::add(const Histogram &other) {
+    if (other._count == 0) {
+        return;
+    }
+    for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+        _counts[i] += other._counts[i];
+    }
+    _min = _count == 0 ? other._min : std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+    _sum += other._sum;
+    _count += other._count;
+}
+
+void Histogram::reset() {
+    _counts.fill(0);
+    _count = 0;
+    _sum = 0;
+    _min = 0;
+    _max = 0;
+}
+
+std::uint64_t Histogram::count() const {
+    return _count;
+}
+
+double Histogram::mean() const {
+    return _count == 0 ? 0.0 : static_cast<double>(_sum) / static_cast<double>(_count);
+}
+
+std::uint64_t Histogram::min() const {
+    return _min;
+}
+
+std::uint64_t Histogram::max() const {
+    return _max;
+}
+
+std::uint64_t Histogram::percentile(double percentile) const {
+    if (_count == 0) {
+        return 0;
+    }
+    // nearest rank
+    auto rank = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(_count)));
+    rank = std::clamp<std::uint64_t>(rank, 1, _count);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += _counts[i];
+        if (seen >= rank) {
+            // the last bucket holds everything too big to count, max is the best there is for it
+            return i == BUCKET_COUNT - 1 ? _max : std::clamp(highestEquivalentValue(i), _min, _max);
+        }
+    }
+    return _max;
+}
+
+std::size_t Histogram::bucketIndex(std::uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<std::size_t>(value);
+    }
+    // shift so the top SUB_BUCKET_BITS bits are left, which is between half and all of SUB_BUCKET_COUNT.
+    // each shift gets half a set of sub-buckets after the exact ones.
+    int highestBit = 0;
+    while ((value >> (highestBit + 1)) != 0) {
+        highestBit++;
+    }
+    int shift = highestBit - (SUB_BUCKET_BITS - 1);
+    return static_cast<std::size_t>(shift * (SUB_BUCKET_COUNT / 2) + (value >> shift));
+}
+
+std::uint64_t Histogram::highestEquivalentValue(std::size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    std::size_t shift = index / (SUB_BUCKET_COUNT / 2) - 1;
+    std::uint64_t subBucket = index - shift * (SUB_BUCKET_COUNT / 2);
+    return ((subBucket + 1) << shift) - 1;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Counts durations in log-linear buckets like HdrHistogram: every power of two is split into the same number
+// of linear sub-buckets, so any percentile is within about 3% of the real value, from a microsecond up to
+// a minute, in a fixed few KiB. Recording is just an increment. Not thread safe.
+class Histogram {
+public:
+    // 32 sub-buckets per power of two above 64
+    static constexpr int SUB_BUCKET_BITS = 6;
+    static constexpr std::uint64_t SUB_BUCKET_COUNT = std::uint64_t(1) << SUB_BUCKET_BITS;
+    static constexpr int HIGHEST_BIT = 26;
+    // in microseconds, about 67 seconds. anything longer is counted as this, max() still has the real value
+    static constexpr std::uint64_t HIGHEST_VALUE = (std::uint64_t(1) << HIGHEST_BIT) - 1;
+
+private:
+    // SUB_BUCKET_COUNT exact ones for the values below it, then half as many for each power of two after
+    static constexpr std::size_t BUCKET_COUNT = SUB_BUCKET_COUNT
+        + (HIGHEST_BIT - SUB_BUCKET_BITS) * (SUB_BUCKET_COUNT / 2);
+
+    std::array<std::uint32_t, BUCKET_COUNT> _counts{};
+    std::uint64_t _count{0};
+    std::uint64_t _sum{0};
+    std::uint64_t _min{0};
+    std::uint64_t _max{0};
+
+public:
+    void record(std::uint64_t microseconds);
+    void add(const Histogram &other);
+    void reset();
+
+    std::uint64_t count() const;
+    // the rest are in microseconds, and 0 without any values
+    double mean() const;
+    std::uint64_t min() const;
+    std::uint64_t max() const;
+    // the biggest value that falls into the same bucket as the value at the percentile, which is 0 to 100
+    std::uint64_t percentile(double percentile) const;
+
+private:
+    static std::size_t bucketIndex(std::uint64_t value);
+    static std::uint64_t highestEquivalentValue(std::size_t index);
+};
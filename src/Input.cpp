@@ -13,8 +13,6 @@ Input::Input(Window &window) {
     }
 
     _lastMousePos = glm::vec2(0.0f, 0.0f);
-
-    setupCallbacks(window);
 }
 
 bool Input::isKeyPressed(int key) const {
@@ -48,8 +46,9 @@ void Input::setMousePos(const glm::vec2 &pos) {
         _firstMouse = false;
     }
 
-    _mouseOffset.x = pos.x - _lastMousePos.x;
-    _mouseOffset.y = _lastMousePos.y - pos.y; // reversed because y-coords go from bottom to top
+    // several cursor events can arrive in one frame, so they add up until the offset is cleared
+    _mouseOffset.x += pos.x - _lastMousePos.x;
+    _mouseOffset.y += _lastMousePos.y - pos.y; // reversed because y-coords go from bottom to top
     _lastMousePos = pos;
 }
 
@@ -57,21 +56,25 @@ glm::vec2 Input::mouseOffset() const {
     return _mouseOffset;
 }
 
+void Input::clearMouseOffset() {
+    _mouseOffset = glm::vec2(0.0f, 0.0f);
+}
+
 void keyCallback(GLFWwindow *glfwWindow, int key, int scancode, int action, int mods) {
     auto window = reinterpret_cast<Window *>(glfwGetWindowUserPointer(glfwWindow));
-    auto input = window->input();
+    auto &input = window->input();
     input.setKeyPressed(key, action != GLFW_RELEASE);
 }
 
 void mouseButtonCallback(GLFWwindow *glfwWindow, int button, int action, int mods) {
     auto window = reinterpret_cast<Window *>(glfwGetWindowUserPointer(glfwWindow));
-    auto input = window->input();
+    auto &input = window->input();
     input.setMouseButtonPressed(button, action != GLFW_RELEASE);
 }
 
 void cursorPosCallback(GLFWwindow *glfwWindow, double xpos, double ypos) {
     auto window = reinterpret_cast<Window *>(glfwGetWindowUserPointer(glfwWindow));
-    auto input = window->input();
+    auto &input = window->input();
     input.setMousePos({xpos, ypos});
 }
 
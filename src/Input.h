@@ -20,7 +20,7 @@ private:
     bool _firstMouse{true};
 
 public:
-    Input(Window &window);
+    explicit Input(Window &window);
 
     bool isKeyPressed(int key) const;
     void setKeyPressed(int key, bool pressed);
@@ -30,9 +30,11 @@ public:
 
     glm::vec2 mousePos() const;
     void setMousePos(const glm::vec2 &pos);
+    // how far the mouse moved since the offset was last cleared
     glm::vec2 mouseOffset() const;
+    void clearMouseOffset();
 
-private:
+    // the window has to exist before the callbacks can be set
     void setupCallbacks(Window &window);
 
 };
@@ -0,0 +1,201 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "Profiler.h"
+
+namespace {
+    thread_local const JobSystem *currentSystem = nullptr;
+    thread_local int currentWorkerIndex = -1;
+}
+
+bool JobCounter::isDone() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _value == 0;
+}
+
+void JobCounter::increment() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _value++;
+}
+
+std::vector<JobCounter::DeferredJob> JobCounter::decrement() {
+    // the whole decrement happens under the lock, so a thread that sees isDone() return true can
+    // safely destroy the counter right away
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<DeferredJob> released;
+    if (--_value == 0) {
+        released.swap(_deferred);
+    }
+    return released;
+}
+
+JobSystem::JobSystem(unsigned int workerCount) {
+    workerCount = std::max(workerCount, 1u);
+    for (unsigned int i = 0; i < workerCount; i++) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    // only start the threads once every worker exists, since they steal from each other
+    for (unsigned int i = 0; i < workerCount; i++) {
+        _workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    _stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wakeCondition.notify_all();
+    for (auto &worker : _workers) {
+        worker->thread.join();
+    }
+}
+
+void JobSystem::schedule(Job job, JobPriority priority, JobCounter *counter) {
+    if (counter) {
+        counter->increment();
+    }
+    push({std::move(job), counter}, priority);
+}
+
+void JobSystem::scheduleAfter(JobCounter &dependency, Job job, JobPriority priority, JobCounter *counter) {
+    if (counter) {
+        counter->increment();
+    }
+    {
+        std::lock_guard<std::mutex> lock(dependency._mutex);
+        if (dependency._value != 0) {
+            dependency._deferred.push_back({std::move(job), priority, counter});
+            return;
+        }
+    }
+    push({std::move(job), counter}, priority);
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    int worker = currentSystem == this ? currentWorkerIndex : -1;
+    while (!counter.isDone()) {
+        if (!tryRunJob(worker)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(std::size_t count, std::size_t batchSize,
+    const std::function<void(std::size_t, std::size_t)> &function, JobPriority priority) {
+    batchSize = std::max<std::size_t>(batchSize, 1);
+    JobCounter counter;
+    for (std::size_t begin = 0; begin < count; begin += batchSize) {
+        std::size_t end = std::min(begin + batchSize, count);
+        schedule([&function, begin, end]() { function(begin, end); }, priority, &counter);
+    }
+    wait(counter);
+}
+
+unsigned int JobSystem::workerCount() const {
+    return static_cast<unsigned int>(_workers.size());
+}
+
+int JobSystem::currentWorker() {
+    return currentWorkerIndex;
+}
+
+unsigned int JobSystem::defaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+void JobSystem::workerLoop(unsigned int index) {
+    currentSystem = this;
+    currentWorkerIndex = static_cast<int>(index);
+    Profiler::setThreadName("worker " + std::to_string(index));
+    while (!_stopping) {
+        if (!tryRunJob(static_cast<int>(index))) {
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _wakeCondition.wait(lock, [this]() { return _queuedJobs > 0 || _stopping; });
+        }
+    }
+}
+
+bool JobSystem::tryRunJob(int preferredWorker) {
+    if (_queuedJobs == 0) {
+        return false;
+    }
+
+    QueuedJob job;
+    bool found = false;
+    // a high priority job anywhere beats a lower priority job in our own queue
+    for (int priority = 0; priority < PRIORITY_COUNT && !found; priority++) {
+        if (preferredWorker >= 0) {
+            Worker &own = *_workers[preferredWorker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            auto &queue = own.queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.back());
+                queue.pop_back();
+                found = true;
+            }
+        }
+
+        // start stealing right after our own worker so thieves don't all hit worker 0
+        auto workerCount = static_cast<int>(_workers.size());
+        for (int i = 1; i <= workerCount && !found; i++) {
+            int victimIndex = (std::max(preferredWorker, 0) + i) % workerCount;
+            if (victimIndex == preferredWorker) {
+                continue;
+            }
+            Worker &victim = *_workers[victimIndex];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            auto &queue = victim.queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.front());
+                queue.pop_front();
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    _queuedJobs--;
+
+    try {
+        Profiler::Zone zone("job");
+        job.job();
+    } catch (const std::exception &exception) {
+        std::cerr << "Job failed: " << exception.what() << std::endl;
+    }
+    finish(job.counter);
+    return true;
+}
+
+void JobSystem::push(QueuedJob job, JobPriority priority) {
+    // jobs spawned by a worker stay on that worker, everything else is spread round-robin
+    unsigned int workerIndex = currentSystem == this
+        ? static_cast<unsigned int>(currentWorkerIndex)
+        : _nextWorker++ % static_cast<unsigned int>(_workers.size());
+    {
+        Worker &worker = *_workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[static_cast<int>(priority)].push_back(std::move(job));
+    }
+    _queuedJobs++;
+    {
+        // taking the lock makes sure a worker that is about to sleep sees the new job
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wakeCondition.notify_one();
+}
+
+void JobSystem::finish(JobCounter *counter) {
+    if (!counter) {
+        return;
+    }
+    for (auto &deferred : counter->decrement()) {
+        push({std::move(deferred.job), deferred.counter}, deferred.priority);
+    }
+}
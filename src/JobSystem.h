@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+enum class JobPriority {
+    // work the player is waiting on right now, like meshing the section they're looking at
+    HIGH,
+    NORMAL,
+    // background work, like generating chunks far away
+    LOW
+};
+
+// Counts unfinished jobs. Jobs can be scheduled to start once a counter reaches zero, which is how
+// dependencies between jobs are expressed.
+class JobCounter {
+private:
+    struct DeferredJob {
+        std::function<void()> job;
+        JobPriority priority;
+        JobCounter *counter;
+    };
+
+    mutable std::mutex _mutex{};
+    int _value{0};
+    std::vector<DeferredJob> _deferred{};
+
+    friend class JobSystem;
+
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter &other) = delete;
+    JobCounter &operator=(const JobCounter &other) = delete;
+
+    bool isDone() const;
+
+private:
+    void increment();
+    // returns the jobs that were waiting for this counter if it just reached zero
+    std::vector<DeferredJob> decrement();
+};
+
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+private:
+    static constexpr int PRIORITY_COUNT = 3;
+
+    struct QueuedJob {
+        Job job;
+        JobCounter *counter;
+    };
+
+    // owners push and pop at the back, thieves take from the front
+    struct Worker {
+        std::mutex mutex{};
+        std::deque<QueuedJob> queues[PRIORITY_COUNT]{};
+        std::thread thread{};
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers{};
+    std::atomic<unsigned int> _nextWorker{0};
+    std::atomic<int> _queuedJobs{0};
+    std::atomic<bool> _stopping{false};
+    std::mutex _sleepMutex{};
+    std::condition_variable _wakeCondition{};
+
+public:
+    // by default leaves one core for the main thread
+    explicit JobSystem(unsigned int workerCount = defaultWorkerCount());
+    ~JobSystem();
+    JobSystem(const JobSystem &other) = delete;
+    JobSystem &operator=(const JobSystem &other) = delete;
+
+    // runs the job on a worker thread. if given, the counter stays above zero until the job has finished.
+    void schedule(Job job, JobPriority priority = JobPriority::NORMAL, JobCounter *counter = nullptr);
+    // like schedule, but the job only becomes runnable once the dependency reaches zero
+    void scheduleAfter(JobCounter &dependency, Job job, JobPriority priority = JobPriority::NORMAL,
+        JobCounter *counter = nullptr);
+
+    // blocks until the counter reaches zero, running queued jobs on this thread in the meantime
+    void wait(JobCounter &counter);
+
+    // splits [0, count) into batches, runs them in parallel and waits for all of them
+    void parallelFor(std::size_t count, std::size_t batchSize,
+        const std::function<void(std::size_t begin, std::size_t end)> &function,
+        JobPriority priority = JobPriority::NORMAL);
+
+    unsigned int workerCount() const;
+    // the index of the worker running the calling thread, or -1 if it isn't a worker
+    static int currentWorker();
+    static unsigned int defaultWorkerCount();
+
+private:
+    void workerLoop(unsigned int index);
+    bool tryRunJob(int preferredWorker);
+    void push(QueuedJob job, JobPriority priority);
+    void finish(JobCounter *counter);
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// Light is stored as one byte per block: sky light in the high nibble, block light in the low one.
+namespace Light {
+    constexpr int MAX_LEVEL = 15;
+    // what new and missing sections have: open sky and no block light
+    constexpr std::uint8_t FULL_SKY = MAX_LEVEL << 4;
+
+    enum class Channel : std::uint8_t {
+        SKY,
+        BLOCK
+    };
+
+    inline int sky(std::uint8_t light) {
+        return light >> 4;
+    }
+
+    inline int block(std::uint8_t light) {
+        return light & 15;
+    }
+
+    inline int level(std::uint8_t light, Channel channel) {
+        return channel == Channel::SKY ? sky(light) : block(light);
+    }
+
+    inline std::uint8_t pack(int sky, int block) {
+        return static_cast<std::uint8_t>((sky << 4) | block);
+    }
+
+    inline std::uint8_t withLevel(std::uint8_t light, Channel channel, int level) {
+        return channel == Channel::SKY ? pack(level, block(light)) : pack(sky(light), level);
+    }
+}
@@ -0,0 +1,446 @@
+#include "LightEngine.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "JobSystem.h"
+
+namespace {
+    constexpr int S = ChunkSection::SIZE;
+    constexpr int HEIGHT = LightEngine::HEIGHT;
+    constexpr int MAX = Light::MAX_LEVEL;
+    constexpr Light::Channel CHANNELS[2] = {Light::Channel::SKY, Light::Channel::BLOCK};
+
+    // in BlockFace order, so DOWN is NEG_Y
+    const glm::ivec3 DIRECTIONS[6] = {{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+    constexpr int DOWN = static_cast<int>(BlockFace::NEG_Y);
+
+    // sky light at full strength goes straight down without getting weaker
+    int spreadLevel(Light::Channel channel, int direction, int level) {
+        return channel == Light::Channel::SKY && direction == DOWN && level == MAX ? MAX : level - 1;
+    }
+
+    bool isOpaque(BlockId block) {
+        return Blocks::info(block).opaque;
+    }
+
+    // one column being lit by lightColumns. only the task's own thread touches it during a round.
+    struct ColumnTask {
+        glm::ivec2 pos{};
+        std::array<ChunkSection *, World::COLUMN_SECTIONS> sections{};
+        std::vector<LightEngine::BorderUpdate> inbox{};
+        std::vector<LightEngine::BorderUpdate> outbox{};
+        // cells to spread from, as y << 8 | z << 4 | x, one queue per channel
+        std::vector<std::uint16_t> queues[2]{};
+
+        static std::uint16_t cell(int x, int y, int z) {
+            return static_cast<std::uint16_t>((y << 8) | (z << 4) | x);
+        }
+
+        ChunkSection *section(int y) const {
+            return sections[y >> 4];
+        }
+
+        void fetch(World &world) {
+            for (int sectionY = 0; sectionY < World::COLUMN_SECTIONS; sectionY++) {
+                sections[sectionY] = world.getSection({pos.x, sectionY, pos.y});
+            }
+        }
+
+        // raises each channel of a cell to at least light, queueing the channels that went up
+        void raise(int x, int y, int z, std::uint8_t light) {
+            ChunkSection *target = section(y);
+            if (!target || isOpaque(target->get(x, y & 15, z))) {
+                return;
+            }
+            std::uint8_t current = target->getLight(x, y & 15, z);
+            std::uint8_t raised = current;
+            for (int c = 0; c < 2; c++) {
+                if (Light::level(light, CHANNELS[c]) > Light::level(current, CHANNELS[c])) {
+                    raised = Light::withLevel(raised, CHANNELS[c], Light::level(light, CHANNELS[c]));
+                    queues[c].push_back(cell(x, y, z));
+                }
+            }
+            if (raised != current) {
+                target->setLight(x, y & 15, z, raised);
+            }
+        }
+
+        void propagate(Light::Channel channel) {
+            auto &queue = queues[channel == Light::Channel::SKY ? 0 : 1];
+            for (std::size_t head = 0; head < queue.size(); head++) {
+                int x = queue[head] & 15;
+                int z = (queue[head] >> 4) & 15;
+                int y = queue[head] >> 8;
+                int level = Light::level(section(y)->getLight(x, y & 15, z), channel);
+                for (int d = 0; d < 6; d++) {
+                    int next = spreadLevel(channel, d, level);
+                    int nx = x + DIRECTIONS[d].x, ny = y + DIRECTIONS[d].y, nz = z + DIRECTIONS[d].z;
+                    if (next <= 0 || ny < 0 || ny >= HEIGHT) {
+                        continue;
+                    }
+                    if (nx < 0 || nx >= S || nz < 0 || nz >= S) {
+                        // another column's light, which only its own task may touch
+                        outbox.push_back({{pos.x * S + nx, ny, pos.y * S + nz}, Light::withLevel(0, channel, next)});
+                        continue;
+                    }
+                    ChunkSection *target = section(ny);
+                    if (!target || isOpaque(target->get(nx, ny & 15, nz))) {
+                        continue;
+                    }
+                    std::uint8_t current = target->getLight(nx, ny & 15, nz);
+                    if (Light::level(current, channel) >= next) {
+                        continue;
+                    }
+                    target->setLight(nx, ny & 15, nz, Light::withLevel(current, channel, next));
+                    queue.push_back(cell(nx, ny, nz));
+                }
+            }
+            queue.clear();
+        }
+
+        void applyInbox() {
+            for (const auto &update : inbox) {
+                raise(update.pos.x - pos.x * S, update.pos.y, update.pos.z - pos.y * S, update.light);
+            }
+            inbox.clear();
+        }
+    };
+
+    // height of the first block open to the sky, for 16 cells along one side of a column
+    void borderHeights(const World &world, const glm::ivec2 &column, int side, int heights[S]) {
+        for (int i = 0; i < S; i++) {
+            int x = side == 0 ? S - 1 : side == 1 ? 0 : i;
+            int z = side == 2 ? S - 1 : side == 3 ? 0 : i;
+            int y = HEIGHT - 1;
+            for (; y >= 0; y--) {
+                const ChunkSection *section = world.getSection({column.x, y >> 4, column.y});
+                if (!section) {
+                    // skip the whole missing section
+                    y &= ~15;
+                    continue;
+                }
+                if (isOpaque(section->get(x, y & 15, z))) {
+                    break;
+                }
+            }
+            heights[i] = y + 1;
+        }
+    }
+
+    void initColumn(World &world, ColumnTask &task, const std::unordered_set<glm::ivec2, ColumnPosHash> &litNeighbours) {
+        task.fetch(world);
+        int topSection = World::COLUMN_SECTIONS;
+        while (topSection > 0 && !task.sections[topSection - 1]) {
+            topSection--;
+        }
+        const int top = topSection * S;
+
+        // straight down from the sky first
+        int heights[S * S];
+        int maxHeight = 0;
+        for (int z = 0; z < S; z++) {
+            for (int x = 0; x < S; x++) {
+                int y = top - 1;
+                while (y >= 0 && (!task.section(y) || !isOpaque(task.section(y)->get(x, y & 15, z)))) {
+                    y--;
+                }
+                heights[z * S + x] = y + 1;
+                maxHeight = std::max(maxHeight, y + 1);
+            }
+        }
+        for (int sectionY = 0; sectionY < topSection; sectionY++) {
+            ChunkSection *section = task.sections[sectionY];
+            if (!section) {
+                continue;
+            }
+            int minY = sectionY * S;
+            if (minY >= maxHeight) {
+                section->fillLight(Light::FULL_SKY);
+                continue;
+            }
+            section->fillLight(0);
+            for (int z = 0; z < S; z++) {
+                for (int x = 0; x < S; x++) {
+                    for (int y = std::max(heights[z * S + x], minY); y < minY + S; y++) {
+                        section->setLight(x, y - minY, z, Light::FULL_SKY);
+                    }
+                }
+            }
+        }
+
+        // then sideways, from every sky lit cell next to a cell the sky doesn't reach straight down
+        int sides[4][S];
+        static const glm::ivec2 SIDE_OFFSETS[4] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        for (int side = 0; side < 4; side++) {
+            borderHeights(world, task.pos + SIDE_OFFSETS[side], side, sides[side]);
+        }
+        auto &skyQueue = task.queues[0];
+        for (int z = 0; z < S; z++) {
+            for (int x = 0; x < S; x++) {
+                int height = heights[z * S + x];
+                int highestNeighbour = 0;
+                for (int side = 0; side < 4; side++) {
+                    int nx = x + SIDE_OFFSETS[side].x, nz = z + SIDE_OFFSETS[side].y;
+                    int neighbour = nx < 0 || nx >= S ? sides[side][nz] : nz < 0 || nz >= S ? sides[side][nx]
+                        : heights[nz * S + nx];
+                    highestNeighbour = std::max(highestNeighbour, neighbour);
+                }
+                for (int y = height; y < std::min(highestNeighbour, top); y++) {
+                    skyQueue.push_back(ColumnTask::cell(x, y, z));
+                }
+            }
+        }
+
+        // block light from every light source
+        auto &blockQueue = task.queues[1];
+        for (int sectionY = 0; sectionY < topSection; sectionY++) {
+            ChunkSection *section = task.sections[sectionY];
+            if (!section || std::none_of(section->palette().begin(), section->palette().end(),
+                    [](BlockId block) { return Blocks::info(block).lightEmission > 0; })) {
+                continue;
+            }
+            for (int y = 0; y < S; y++) {
+                for (int z = 0; z < S; z++) {
+                    for (int x = 0; x < S; x++) {
+                        int emission = Blocks::info(section->get(x, y, z)).lightEmission;
+                        if (emission > 0) {
+                            std::uint8_t light = section->getLight(x, y, z);
+                            section->setLight(x, y, z, Light::withLevel(light, Light::Channel::BLOCK, emission));
+                            blockQueue.push_back(ColumnTask::cell(x, sectionY * S + y, z));
+                        }
+                    }
+                }
+            }
+        }
+
+        // and whatever already lit neighbours shine across the border
+        for (int side = 0; side < 4; side++) {
+            glm::ivec2 neighbourPos = task.pos + SIDE_OFFSETS[side];
+            if (!litNeighbours.count(neighbourPos) || !world.getSection({neighbourPos.x, 0, neighbourPos.y})) {
+                continue;
+            }
+            for (int y = 0; y < top; y++) {
+                const ChunkSection *neighbour = world.getSection({neighbourPos.x, y >> 4, neighbourPos.y});
+                for (int i = 0; i < S; i++) {
+                    int x = side == 0 ? 0 : side == 1 ? S - 1 : i;
+                    int z = side == 2 ? 0 : side == 3 ? S - 1 : i;
+                    int nx = (x + SIDE_OFFSETS[side].x) & 15, nz = (z + SIDE_OFFSETS[side].y) & 15;
+                    std::uint8_t light = neighbour ? neighbour->getLight(nx, y & 15, nz) : Light::FULL_SKY;
+                    int sky = std::max(Light::sky(light) - 1, 0);
+                    int block = std::max(Light::block(light) - 1, 0);
+                    if (sky > 0 || block > 0) {
+                        task.raise(x, y, z, Light::pack(sky, block));
+                    }
+                }
+            }
+        }
+    }
+
+    glm::ivec2 columnOf(const glm::ivec3 &pos) {
+        glm::ivec3 sectionPos = World::toSectionPos(pos);
+        return {sectionPos.x, sectionPos.z};
+    }
+}
+
+void LightEngine::lightColumns(World &world, const std::vector<glm::ivec2> &batch,
+    const std::unordered_set<glm::ivec2, ColumnPosHash> &litNeighbours, JobSystem &jobs,
+    std::vector<BorderUpdate> &outside) {
+    std::vector<ColumnTask> tasks(batch.size());
+    std::unordered_map<glm::ivec2, std::size_t, ColumnPosHash> taskIndices;
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        tasks[i].pos = batch[i];
+        taskIndices[batch[i]] = i;
+    }
+
+    jobs.parallelFor(tasks.size(), 1, [&](std::size_t begin, std::size_t end) {
+        std::shared_lock<std::shared_mutex> lock(world.mutex());
+        for (std::size_t i = begin; i < end; i++) {
+            initColumn(world, tasks[i], litNeighbours);
+            tasks[i].propagate(Light::Channel::SKY);
+            tasks[i].propagate(Light::Channel::BLOCK);
+        }
+    });
+
+    // exchange light over the borders until nothing crosses one anymore. light can't get further than
+    // 15 blocks, so this is over after a couple of rounds.
+    std::vector<std::size_t> active;
+    while (true) {
+        active.clear();
+        for (auto &task : tasks) {
+            for (const auto &update : task.outbox) {
+                auto target = taskIndices.find(columnOf(update.pos));
+                if (target == taskIndices.end()) {
+                    outside.push_back(update);
+                    continue;
+                }
+                if (tasks[target->second].inbox.empty()) {
+                    active.push_back(target->second);
+                }
+                tasks[target->second].inbox.push_back(update);
+            }
+            task.outbox.clear();
+        }
+        if (active.empty()) {
+            break;
+        }
+
+        jobs.parallelFor(active.size(), 1, [&](std::size_t begin, std::size_t end) {
+            std::shared_lock<std::shared_mutex> lock(world.mutex());
+            for (std::size_t i = begin; i < end; i++) {
+                ColumnTask &task = tasks[active[i]];
+                // the sections may have been unloaded between rounds
+                task.fetch(world);
+                task.applyInbox();
+                task.propagate(Light::Channel::SKY);
+                task.propagate(Light::Channel::BLOCK);
+            }
+        });
+    }
+}
+
+void LightEngine::update(World &world, const std::vector<glm::ivec3> &changedBlocks, const ColumnPredicate &isLit) {
+    begin(world, isLit);
+    for (Light::Channel channel : CHANNELS) {
+        _decrease.clear();
+        _increase.clear();
+        for (const auto &pos : changedBlocks) {
+            ChunkSection *section;
+            if (pos.y < 0 || pos.y >= HEIGHT || !lookup(pos, section) || !section) {
+                continue;
+            }
+            glm::ivec3 local = World::toLocalPos(pos);
+            BlockId block = section->get(local.x, local.y, local.z);
+            int old = Light::level(section->getLight(local.x, local.y, local.z), channel);
+            if (old > 0) {
+                setLevel(*section, pos, channel, 0);
+                _decrease.push_back({pos, old});
+            }
+            int emission = channel == Light::Channel::BLOCK ? Blocks::info(block).lightEmission : 0;
+            if (emission > 0) {
+                setLevel(*section, pos, channel, emission);
+                _increase.push_back(pos);
+            }
+            // the neighbours shine into the block again if it lets light through
+            if (!isOpaque(block)) {
+                for (const auto &direction : DIRECTIONS) {
+                    _increase.push_back(pos + direction);
+                }
+            }
+        }
+        decrease(channel);
+        increase(channel);
+    }
+}
+
+void LightEngine::apply(World &world, const std::vector<BorderUpdate> &updates, const ColumnPredicate &isLit) {
+    begin(world, isLit);
+    for (Light::Channel channel : CHANNELS) {
+        _increase.clear();
+        for (const auto &update : updates) {
+            ChunkSection *section;
+            if (!lookup(update.pos, section) || !section) {
+                continue;
+            }
+            glm::ivec3 local = World::toLocalPos(update.pos);
+            int level = Light::level(update.light, channel);
+            if (isOpaque(section->get(local.x, local.y, local.z))
+                || Light::level(section->getLight(local.x, local.y, local.z), channel) >= level) {
+                continue;
+            }
+            setLevel(*section, update.pos, channel, level);
+            _increase.push_back(update.pos);
+        }
+        increase(channel);
+    }
+}
+
+void LightEngine::begin(World &world, const ColumnPredicate &isLit) {
+    _world = &world;
+    _isLit = &isLit;
+    _hasCache = false;
+}
+
+bool LightEngine::lookup(const glm::ivec3 &pos, ChunkSection *&section) {
+    glm::ivec3 sectionPos = World::toSectionPos(pos);
+    if (!_hasCache || sectionPos != _cachedSectionPos) {
+        _cachedSectionPos = sectionPos;
+        _cachedReadable = (*_isLit)({sectionPos.x, sectionPos.z});
+        _cachedSection = _cachedReadable ? _world->getSection(sectionPos) : nullptr;
+        _hasCache = true;
+    }
+    section = _cachedSection;
+    return _cachedReadable;
+}
+
+void LightEngine::setLevel(ChunkSection &section, const glm::ivec3 &pos, Light::Channel channel, int level) {
+    glm::ivec3 local = World::toLocalPos(pos);
+    std::uint8_t light = section.getLight(local.x, local.y, local.z);
+    section.setLight(local.x, local.y, local.z, Light::withLevel(light, channel, level));
+    _world->markDirty(pos);
+}
+
+void LightEngine::decrease(Light::Channel channel) {
+    for (std::size_t i = 0; i < _decrease.size(); i++) {
+        Node node = _decrease[i];
+        for (int d = 0; d < 6; d++) {
+            glm::ivec3 pos = node.pos + DIRECTIONS[d];
+            ChunkSection *section;
+            if (pos.y < 0 || pos.y >= HEIGHT || !lookup(pos, section)) {
+                continue;
+            }
+            glm::ivec3 local = World::toLocalPos(pos);
+            int level = section ? Light::level(section->getLight(local.x, local.y, local.z), channel)
+                : Light::level(Light::FULL_SKY, channel);
+            if (level == 0) {
+                continue;
+            }
+            // light that came from the removed value goes too, anything brighter spreads back in later
+            bool dependent = level < node.level || (level == MAX && spreadLevel(channel, d, node.level) == MAX);
+            if (!dependent || !section) {
+                _increase.push_back(pos);
+                continue;
+            }
+            setLevel(*section, pos, channel, 0);
+            _decrease.push_back({pos, level});
+            int emission = channel == Light::Channel::BLOCK
+                ? Blocks::info(section->get(local.x, local.y, local.z)).lightEmission : 0;
+            if (emission > 0) {
+                setLevel(*section, pos, channel, emission);
+                _increase.push_back(pos);
+            }
+        }
+    }
+}
+
+void LightEngine::increase(Light::Channel channel) {
+    for (std::size_t i = 0; i < _increase.size(); i++) {
+        glm::ivec3 pos = _increase[i];
+        ChunkSection *section;
+        if (pos.y < 0 || pos.y >= HEIGHT || !lookup(pos, section)) {
+            continue;
+        }
+        glm::ivec3 local = World::toLocalPos(pos);
+        int level = section ? Light::level(section->getLight(local.x, local.y, local.z), channel)
+            : Light::level(Light::FULL_SKY, channel);
+        for (int d = 0; d < 6; d++) {
+            int next = spreadLevel(channel, d, level);
+            glm::ivec3 neighbourPos = pos + DIRECTIONS[d];
+            ChunkSection *neighbour;
+            if (next <= 0 || neighbourPos.y < 0 || neighbourPos.y >= HEIGHT || !lookup(neighbourPos, neighbour)
+                || !neighbour) {
+                continue;
+            }
+            glm::ivec3 neighbourLocal = World::toLocalPos(neighbourPos);
+            if (isOpaque(neighbour->get(neighbourLocal.x, neighbourLocal.y, neighbourLocal.z))
+                || Light::level(neighbour->getLight(neighbourLocal.x, neighbourLocal.y, neighbourLocal.z), channel) >= next) {
+                continue;
+            }
+            setLevel(*neighbour, neighbourPos, channel, next);
+            _increase.push_back(neighbourPos);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "ChunkSection.h"
+#include "Light.h"
+#include "World.h"
+
+class JobSystem;
+
+// Flood fill lighting for sky light and block light.
+//
+// New columns are lit from scratch in batches by lightColumns, spread over the job system. Every column
+// in a batch is lit by one task, and a task only ever writes its own column's light. Light that crosses
+// into another column is handed over as border updates between rounds instead of locking anything, and
+// the rounds go on until no more light crosses a border inside the batch.
+//
+// Changes to columns that are already lit, from block edits or from light coming in from a newly lit
+// neighbour, go through update and apply on a single thread. Removing light uses the usual two queues:
+// light that depended on the old value is cleared first, then everything around its edge spreads again.
+//
+// Sections missing from the world are treated as open sky and are never written to.
+class LightEngine {
+public:
+    static constexpr int HEIGHT = World::COLUMN_SECTIONS * ChunkSection::SIZE;
+
+    struct BorderUpdate {
+        glm::ivec3 pos;
+        // the block should end up with at least this much of each channel
+        std::uint8_t light;
+    };
+
+    // says whether a column's light is ready, so the single threaded updates may read and change it
+    using ColumnPredicate = std::function<bool(const glm::ivec2 &column)>;
+
+private:
+    struct Node {
+        glm::ivec3 pos;
+        int level;
+    };
+
+    // reused between updates
+    std::vector<Node> _decrease{};
+    std::vector<glm::ivec3> _increase{};
+
+    // the last section looked up, since flood fills rarely leave a section
+    World *_world{nullptr};
+    const ColumnPredicate *_isLit{nullptr};
+    glm::ivec3 _cachedSectionPos{0, 0, 0};
+    ChunkSection *_cachedSection{nullptr};
+    bool _cachedReadable{false};
+    bool _hasCache{false};
+
+public:
+    // lights every column in batch from scratch, with every task holding the world's mutex shared. their
+    // neighbours have to be loaded. light coming from neighbours in litNeighbours is pulled in, and light
+    // going into columns outside the batch is appended to outside for the caller to apply once the
+    // batch's columns can be touched from other threads.
+    static void lightColumns(World &world, const std::vector<glm::ivec2> &batch,
+        const std::unordered_set<glm::ivec2, ColumnPosHash> &litNeighbours, JobSystem &jobs,
+        std::vector<BorderUpdate> &outside);
+
+    // relights around blocks that were changed in lit columns. the world's mutex must be held exclusively.
+    // marks every block whose light changed as dirty.
+    void update(World &world, const std::vector<glm::ivec3> &changedBlocks, const ColumnPredicate &isLit);
+    // raises the light of lit blocks to at least what the updates say and spreads it. same rules as update.
+    void apply(World &world, const std::vector<BorderUpdate> &updates, const ColumnPredicate &isLit);
+
+private:
+    void begin(World &world, const ColumnPredicate &isLit);
+    // returns false if the block's column isn't lit. section is null if the block is in a missing section.
+    bool lookup(const glm::ivec3 &pos, ChunkSection *&section);
+    void setLevel(ChunkSection &section, const glm::ivec3 &pos, Light::Channel channel, int level);
+
+    void decrease(Light::Channel channel);
+    void increase(Light::Channel channel);
+};
@@ -0,0 +1,145 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path) : _path(path) {
+    _file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open '" + path + "' (error " + std::to_string(GetLastError()) + ")");
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(_file, &size);
+    map(static_cast<std::size_t>(size.QuadPart));
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+    CloseHandle(_file);
+}
+
+void MappedFile::write(std::size_t offset, const void *data, std::size_t length) {
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+    overlapped.OffsetHigh = static_cast<DWORD>(static_cast<std::uint64_t>(offset) >> 32);
+    DWORD written = 0;
+    if (!WriteFile(_file, data, static_cast<DWORD>(length), &written, &overlapped) || written != length) {
+        throw std::runtime_error("Could not write to '" + _path + "' (error " + std::to_string(GetLastError()) + ")");
+    }
+    if (offset + length > _size) {
+        unmap();
+        map(offset + length);
+    }
+}
+
+void MappedFile::map(std::size_t size) {
+    _size = size;
+    // empty files can't be mapped
+    if (size == 0) {
+        return;
+    }
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mapping) {
+        throw std::runtime_error("Could not map '" + _path + "' (error " + std::to_string(GetLastError()) + ")");
+    }
+    _data = static_cast<const std::uint8_t *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!_data) {
+        throw std::runtime_error("Could not map '" + _path + "' (error " + std::to_string(GetLastError()) + ")");
+    }
+}
+
+void MappedFile::unmap() {
+    if (_data) {
+        UnmapViewOfFile(_data);
+        _data = nullptr;
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) : _path(path) {
+    _fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        throw std::runtime_error("Could not open '" + path + "': " + std::strerror(errno));
+    }
+    struct stat info{};
+    fstat(_fd, &info);
+    map(static_cast<std::size_t>(info.st_size));
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+    close(_fd);
+}
+
+void MappedFile::write(std::size_t offset, const void *data, std::size_t length) {
+    auto bytes = static_cast<const char *>(data);
+    std::size_t done = 0;
+    while (done < length) {
+        ssize_t written = pwrite(_fd, bytes + done, length - done, static_cast<off_t>(offset + done));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Could not write to '" + _path + "': " + std::strerror(errno));
+        }
+        done += static_cast<std::size_t>(written);
+    }
+    // the mapping shares the page cache with pwrite, so only growing the file needs a new mapping
+    if (offset + length > _size) {
+        unmap();
+        map(offset + length);
+    }
+}
+
+void MappedFile::map(std::size_t size) {
+    _size = size;
+    // empty files can't be mapped
+    if (size == 0) {
+        return;
+    }
+    void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, _fd, 0);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Could not map '" + _path + "': " + std::strerror(errno));
+    }
+    _data = static_cast<const std::uint8_t *>(address);
+}
+
+void MappedFile::unmap() {
+    if (_data) {
+        munmap(const_cast<std::uint8_t *>(_data), _size);
+        _data = nullptr;
+    }
+}
+
+#endif
+
+const std::uint8_t *MappedFile::data() const {
+    return _data;
+}
+
+std::size_t MappedFile::size() const {
+    return _size;
+}
+
+const std::string &MappedFile::path() const {
+    return _path;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A file that is read through a read-only memory mapping and written with positioned writes. The
+// mapping is recreated whenever a write grows the file, which invalidates pointers from data().
+class MappedFile {
+private:
+#ifdef _WIN32
+    void *_file{nullptr};
+    void *_mapping{nullptr};
+#else
+    int _fd{-1};
+#endif
+    const std::uint8_t *_data{nullptr};
+    std::size_t _size{0};
+    std::string _path;
+
+public:
+    // opens the file for reading and writing, creating it if it doesn't exist
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &other) = delete;
+    MappedFile &operator=(const MappedFile &other) = delete;
+
+    const std::uint8_t *data() const;
+    std::size_t size() const;
+    const std::string &path() const;
+
+    void write(std::size_t offset, const void *data, std::size_t length);
+
+private:
+    void map(std::size_t size);
+    void unmap();
+};
@@ -0,0 +1,170 @@
+#include "Memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <utility>
+
+namespace {
+    // one cache line each, so threads counting different tags don't fight over it
+    struct alignas(64) Counter {
+        std::atomic<std::int64_t> bytes{0};
+        std::atomic<std::int64_t> peakBytes{0};
+        std::atomic<std::int64_t> allocations{0};
+        std::atomic<std::size_t> budgetBytes{0};
+    };
+
+    std::array<std::array<Counter, MEMORY_TAG_COUNT>, MEMORY_DOMAIN_COUNT> counters;
+
+    Counter &counter(MemoryDomain domain, MemoryTag tag) {
+        return counters[static_cast<std::size_t>(domain)][static_cast<std::size_t>(tag)];
+    }
+
+    void change(MemoryDomain domain, MemoryTag tag, std::int64_t bytes, std::int64_t allocations) {
+        Counter &counter = ::counter(domain, tag);
+        if (allocations != 0) {
+            counter.allocations.fetch_add(allocations, std::memory_order_relaxed);
+        }
+        std::int64_t now = counter.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::int64_t peak = counter.peakBytes.load(std::memory_order_relaxed);
+        while (now > peak && !counter.peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::size_t unsignedValue(const std::atomic<std::int64_t> &value) {
+        return static_cast<std::size_t>(std::max<std::int64_t>(value.load(std::memory_order_relaxed), 0));
+    }
+
+    double mebibytes(std::size_t bytes) {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+bool MemoryUsage::isOverBudget() const {
+    return budgetBytes != 0 && bytes > budgetBytes;
+}
+
+const MemoryUsage &MemoryReport::get(MemoryDomain domain, MemoryTag tag) const {
+    return usage[static_cast<std::size_t>(domain)][static_cast<std::size_t>(tag)];
+}
+
+std::size_t MemoryReport::totalBytes(MemoryDomain domain) const {
+    std::size_t total = 0;
+    for (const MemoryUsage &tagUsage : usage[static_cast<std::size_t>(domain)]) {
+        total += tagUsage.bytes;
+    }
+    return total;
+}
+
+std::ostream &operator<<(std::ostream &stream, const MemoryReport &report) {
+    stream << std::fixed << std::setprecision(2);
+    for (std::size_t domain = 0; domain < MEMORY_DOMAIN_COUNT; domain++) {
+        stream << MEMORY_DOMAIN_NAMES[domain] << ": " << mebibytes(report.totalBytes(static_cast<MemoryDomain>(domain)))
+            << " MiB\n";
+        for (std::size_t tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+            const MemoryUsage &usage = report.usage[domain][tag];
+            if (usage.peakBytes == 0 && usage.budgetBytes == 0) {
+                continue;
+            }
+            stream << "    " << std::setw(9) << MEMORY_TAG_NAMES[tag] << ": " << mebibytes(usage.bytes) << " MiB in "
+                << usage.allocations << " allocations, peak " << mebibytes(usage.peakBytes) << " MiB";
+            if (usage.budgetBytes != 0) {
+                stream << ", budget " << mebibytes(usage.budgetBytes) << " MiB";
+                if (usage.isOverBudget()) {
+                    stream << " (OVER BUDGET)";
+                }
+            }
+            stream << "\n";
+        }
+    }
+    return stream;
+}
+
+namespace Memory {
+    void add(MemoryDomain domain, MemoryTag tag, std::size_t bytes) {
+        change(domain, tag, static_cast<std::int64_t>(bytes), 1);
+    }
+
+    void remove(MemoryDomain domain, MemoryTag tag, std::size_t bytes) {
+        change(domain, tag, -static_cast<std::int64_t>(bytes), -1);
+    }
+
+    MemoryUsage usage(MemoryDomain domain, MemoryTag tag) {
+        const Counter &counter = ::counter(domain, tag);
+        MemoryUsage usage;
+        usage.bytes = unsignedValue(counter.bytes);
+        usage.peakBytes = unsignedValue(counter.peakBytes);
+        usage.allocations = unsignedValue(counter.allocations);
+        usage.budgetBytes = counter.budgetBytes.load(std::memory_order_relaxed);
+        return usage;
+    }
+
+    MemoryReport report() {
+        MemoryReport report;
+        for (std::size_t domain = 0; domain < MEMORY_DOMAIN_COUNT; domain++) {
+            for (std::size_t tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+                report.usage[domain][tag] = usage(static_cast<MemoryDomain>(domain), static_cast<MemoryTag>(tag));
+            }
+        }
+        return report;
+    }
+
+    void resetPeaks() {
+        for (auto &domain : counters) {
+            for (Counter &counter : domain) {
+                counter.peakBytes.store(counter.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void setBudget(MemoryDomain domain, MemoryTag tag, std::size_t bytes) {
+        counter(domain, tag).budgetBytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    std::size_t textureBytes(unsigned int width, unsigned int height, unsigned int layers,
+        unsigned int bytesPerTexel, bool mipmapped) {
+        std::size_t bytes = 0;
+        while (true) {
+            bytes += static_cast<std::size_t>(width) * height * layers * bytesPerTexel;
+            if (!mipmapped || (width == 1 && height == 1)) {
+                return bytes;
+            }
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+    }
+
+    Allocation::Allocation(MemoryDomain domain, MemoryTag tag, std::size_t bytes)
+        : _domain(domain), _tag(tag) {
+        resize(bytes);
+    }
+
+    Allocation::~Allocation() {
+        resize(0);
+    }
+
+    Allocation::Allocation(Allocation &&other) noexcept
+        : _domain(other._domain), _tag(other._tag), _bytes(std::exchange(other._bytes, 0)) {
+    }
+
+    Allocation &Allocation::operator=(Allocation &&other) noexcept {
+        std::swap(_domain, other._domain);
+        std::swap(_tag, other._tag);
+        std::swap(_bytes, other._bytes);
+        return *this;
+    }
+
+    void Allocation::resize(std::size_t bytes) {
+        if (bytes == _bytes) {
+            return;
+        }
+        // only going from or to nothing changes how many allocations there are
+        std::int64_t allocations = _bytes == 0 ? 1 : (bytes == 0 ? -1 : 0);
+        change(_domain, _tag, static_cast<std::int64_t>(bytes) - static_cast<std::int64_t>(_bytes), allocations);
+        _bytes = bytes;
+    }
+
+    std::size_t Allocation::bytes() const {
+        return _bytes;
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// What memory is used for. Every tracked allocation counts towards one of these.
+enum class MemoryTag : std::uint8_t {
+    // sections with their palettes and packed blocks
+    CHUNKS,
+    // the per block light of sections
+    LIGHT,
+    // chunk vertices: meshes on the CPU, the chunk renderer's pages and staging on the GPU
+    MESHES,
+    // decoded images on the CPU, textures and their staging on the GPU
+    TEXTURES,
+    // linked programs
+    SHADERS,
+    // render queue packets, draw commands and uniform buffers
+    RENDERING
+};
+
+constexpr std::size_t MEMORY_TAG_COUNT = 6;
+
+constexpr const char *MEMORY_TAG_NAMES[MEMORY_TAG_COUNT] = {"chunks", "light", "meshes", "textures", "shaders",
+    "rendering"};
+
+enum class MemoryDomain : std::uint8_t {
+    CPU,
+    // estimated from the sizes and formats resources were created with, drivers may add padding
+    GPU
+};
+
+constexpr std::size_t MEMORY_DOMAIN_COUNT = 2;
+
+constexpr const char *MEMORY_DOMAIN_NAMES[MEMORY_DOMAIN_COUNT] = {"cpu", "gpu"};
+
+struct MemoryUsage {
+    std::size_t bytes{0};
+    // the most there was at once since the last Memory::resetPeaks
+    std::size_t peakBytes{0};
+    // live allocations
+    std::size_t allocations{0};
+    // 0 without one
+    std::size_t budgetBytes{0};
+
+    bool isOverBudget() const;
+};
+
+struct MemoryReport {
+    // indexed by MemoryDomain, then MemoryTag
+    std::array<std::array<MemoryUsage, MEMORY_TAG_COUNT>, MEMORY_DOMAIN_COUNT> usage{};
+
+    const MemoryUsage &get(MemoryDomain domain, MemoryTag tag) const;
+    std::size_t totalBytes(MemoryDomain domain) const;
+};
+
+std::ostream &operator<<(std::ostream &stream, const MemoryReport &report);
+
+// Counts memory per tag, for a live breakdown of where it goes and how high it got. Counting is a few
+// relaxed atomics, so it's fine from any thread.
+//
+// CPU memory is counted by giving containers a Memory::Allocator. GPU resources count their own size with
+// a Memory::Allocation.
+namespace Memory {
+    void add(MemoryDomain domain, MemoryTag tag, std::size_t bytes);
+    void remove(MemoryDomain domain, MemoryTag tag, std::size_t bytes);
+
+    MemoryUsage usage(MemoryDomain domain, MemoryTag tag);
+    MemoryReport report();
+    // peaks start over from what's used now
+    void resetPeaks();
+    // usage over the budget is reported, nothing is refused. 0 removes the budget.
+    void setBudget(MemoryDomain domain, MemoryTag tag, std::size_t bytes);
+
+    // of a texture with every mip level down to 1x1 if mipmapped. layers is 1 for plain 2D textures.
+    std::size_t textureBytes(unsigned int width, unsigned int height, unsigned int layers,
+        unsigned int bytesPerTexel, bool mipmapped);
+
+    // A standard allocator that counts everything it hands out towards TAG.
+    template<typename T, MemoryTag TAG>
+    class Allocator {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = Allocator<U, TAG>;
+        };
+
+        Allocator() = default;
+        template<typename U>
+        Allocator(const Allocator<U, TAG> &other) noexcept {
+        }
+
+        T *allocate(std::size_t count) {
+            T *pointer = std::allocator<T>().allocate(count);
+            add(MemoryDomain::CPU, TAG, count * sizeof(T));
+            return pointer;
+        }
+
+        void deallocate(T *pointer, std::size_t count) noexcept {
+            std::allocator<T>().deallocate(pointer, count);
+            remove(MemoryDomain::CPU, TAG, count * sizeof(T));
+        }
+
+        template<typename U>
+        bool operator==(const Allocator<U, TAG> &other) const noexcept {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const Allocator<U, TAG> &other) const noexcept {
+            return false;
+        }
+    };
+
+    template<typename T, MemoryTag TAG>
+    using Vector = std::vector<T, Allocator<T, TAG>>;
+
+    // Counts bytes towards a tag for as long as it lives, for things that aren't allocated through an
+    // Allocator, like GPU resources. Moving hands the count over.
+    class Allocation {
+    private:
+        MemoryDomain _domain{MemoryDomain::CPU};
+        MemoryTag _tag{MemoryTag::CHUNKS};
+        std::size_t _bytes{0};
+
+    public:
+        Allocation() = default;
+        Allocation(MemoryDomain domain, MemoryTag tag, std::size_t bytes);
+        ~Allocation();
+        Allocation(const Allocation &other) = delete;
+        Allocation &operator=(const Allocation &other) = delete;
+        Allocation(Allocation &&other) noexcept;
+        Allocation &operator=(Allocation &&other) noexcept;
+
+        // for resources that grow or shrink, like buffers that are given new data
+        void resize(std::size_t bytes);
+        std::size_t bytes() const;
+    };
+}
@@ -0,0 +1,166 @@
+#include "Mesher.h"
+
+#include "World.h"
+
+std::size_t MeshData::quadCount() const {
+    return vertices.size() / 4;
+}
+
+bool MeshData::isEmpty() const {
+    return vertices.empty();
+}
+
+void MeshData::clear() {
+    vertices.clear();
+    passVertexCounts.fill(0);
+    faceCount = 0;
+}
+
+Mesher::Mesher() : _blocks(PADDED_VOLUME, Blocks::AIR), _light(PADDED_VOLUME, Light::FULL_SKY) {
+}
+
+void Mesher::gather(const World &world, const glm::ivec3 &sectionPos) {
+    constexpr int S = ChunkSection::SIZE;
+    for (int oy = -1; oy <= 1; oy++) {
+        for (int oz = -1; oz <= 1; oz++) {
+            for (int ox = -1; ox <= 1; ox++) {
+                const ChunkSection *section = world.getSection(sectionPos + glm::ivec3(ox, oy, oz));
+                // for neighbours only the layer touching this section is needed
+                int minX = ox == -1 ? S - 1 : 0, maxX = ox == 1 ? 0 : S - 1;
+                int minY = oy == -1 ? S - 1 : 0, maxY = oy == 1 ? 0 : S - 1;
+                int minZ = oz == -1 ? S - 1 : 0, maxZ = oz == 1 ? 0 : S - 1;
+                for (int y = minY; y <= maxY; y++) {
+                    for (int z = minZ; z <= maxZ; z++) {
+                        for (int x = minX; x <= maxX; x++) {
+                            int index = paddedIndex(x + ox * S, y + oy * S, z + oz * S);
+                            _blocks[index] = section ? section->get(x, y, z) : Blocks::AIR;
+                            _light[index] = section ? section->getLight(x, y, z) : Light::FULL_SKY;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Mesher::mesh(MeshData &out) {
+    out.clear();
+    for (auto &passVertices : _passVertices) {
+        passVertices.clear();
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        meshFace(axis, false, out);
+        meshFace(axis, true, out);
+    }
+    for (std::size_t pass = 0; pass < RENDER_PASS_COUNT; pass++) {
+        out.vertices.insert(out.vertices.end(), _passVertices[pass].begin(), _passVertices[pass].end());
+        out.passVertexCounts[pass] = static_cast<std::uint32_t>(_passVertices[pass].size());
+    }
+}
+
+void Mesher::mesh(const World &world, const glm::ivec3 &sectionPos, MeshData &out) {
+    // most of the world is air, which doesn't need a gather at all
+    const ChunkSection *section = world.getSection(sectionPos);
+    if (!section || section->isEmpty()) {
+        out.clear();
+        return;
+    }
+    gather(world, sectionPos);
+    mesh(out);
+}
+
+void Mesher::meshFace(int axis, bool positive, MeshData &out) {
+    constexpr int S = ChunkSection::SIZE;
+    // u and v span the face plane, and u x v points along +axis
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    const int face = axis * 2 + (positive ? 1 : 0);
+
+    // walking the padded array with strides avoids recomputing indices for every cell
+    const int strides[3] = {1, PADDED_SIZE * PADDED_SIZE, PADDED_SIZE};
+    const int neighbourOffset = positive ? strides[axis] : -strides[axis];
+
+    for (int slice = 0; slice < S; slice++) {
+        // find every visible face in this slice. mask values are the face's pass in the top byte, its light
+        // in the third byte and texture + 1 below it, 0 means no face.
+        int origin[3] = {0, 0, 0};
+        origin[axis] = slice;
+        const int sliceIndex = paddedIndex(origin[0], origin[1], origin[2]);
+        for (int b = 0; b < S; b++) {
+            int index = sliceIndex + b * strides[v];
+            for (int a = 0; a < S; a++, index += strides[u]) {
+                BlockId block = _blocks[index];
+                std::uint32_t key = 0;
+                if (block != Blocks::AIR) {
+                    BlockId neighbour = _blocks[index + neighbourOffset];
+                    // faces between two of the same see-through block (like water) are hidden too
+                    if (!Blocks::info(neighbour).opaque && neighbour != block) {
+                        const BlockInfo &info = Blocks::info(block);
+                        key = static_cast<std::uint32_t>(info.pass) << 24
+                            | static_cast<std::uint32_t>(_light[index + neighbourOffset]) << 16
+                            | (info.textures[face] + 1u);
+                        out.faceCount++;
+                    }
+                }
+                _mask[b * S + a] = key;
+            }
+        }
+
+        // greedily merge the mask into rectangles, widest first
+        for (int b = 0; b < S; b++) {
+            for (int a = 0; a < S;) {
+                std::uint32_t key = _mask[b * S + a];
+                if (key == 0) {
+                    a++;
+                    continue;
+                }
+
+                int width = 1;
+                while (a + width < S && _mask[b * S + a + width] == key) {
+                    width++;
+                }
+                int height = 1;
+                for (; b + height < S; height++) {
+                    bool rowMatches = true;
+                    for (int k = 0; k < width; k++) {
+                        if (_mask[(b + height) * S + a + k] != key) {
+                            rowMatches = false;
+                            break;
+                        }
+                    }
+                    if (!rowMatches) {
+                        break;
+                    }
+                }
+                for (int h = 0; h < height; h++) {
+                    for (int k = 0; k < width; k++) {
+                        _mask[(b + h) * S + a + k] = 0;
+                    }
+                }
+
+                glm::ivec3 corners[4];
+                for (auto &corner : corners) {
+                    corner[axis] = slice + (positive ? 1 : 0);
+                    corner[u] = a;
+                    corner[v] = b;
+                }
+                corners[1][u] += width;
+                corners[2][u] += width;
+                corners[2][v] += height;
+                corners[3][v] += height;
+
+                // counter-clockwise when seen from outside the block
+                static const int positiveOrder[4] = {0, 1, 2, 3};
+                static const int negativeOrder[4] = {0, 3, 2, 1};
+                const int *order = positive ? positiveOrder : negativeOrder;
+                MeshData::Vertices &vertices = _passVertices[key >> 24];
+                for (int i = 0; i < 4; i++) {
+                    const glm::ivec3 &p = corners[order[i]];
+                    vertices.push_back(BlockVertex::pack({p.x, p.y, p.z, static_cast<BlockFace>(face),
+                        static_cast<std::uint16_t>((key & 0xFFFF) - 1), static_cast<std::uint8_t>(key >> 16 & 0xFF), 0, 0}));
+                }
+                a += width;
+            }
+        }
+    }
+}
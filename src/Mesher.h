@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "Block.h"
+#include "BlockVertex.h"
+#include "ChunkSection.h"
+#include "Memory.h"
+#include "RenderPass.h"
+
+class World;
+
+struct MeshData {
+    using Vertices = Memory::Vector<BlockVertex, MemoryTag::MESHES>;
+
+    // four vertices per quad, drawn with a shared 0 1 2 2 3 0 index pattern. the quads of each pass come
+    // one after the other, in RenderPass order.
+    Vertices vertices{};
+    std::array<std::uint32_t, RENDER_PASS_COUNT> passVertexCounts{};
+    // visible block faces before they were merged into quads
+    std::size_t faceCount{0};
+
+    std::size_t quadCount() const;
+    bool isEmpty() const;
+    // keeps the allocation around so the buffer can be reused for the next section
+    void clear();
+};
+
+// Greedy mesher: merges coplanar faces with the same texture and light into maximal rectangles. Each instance keeps
+// its own scratch buffers, so use one mesher per thread.
+class Mesher {
+public:
+    // the section plus a one block border taken from its 26 neighbours
+    static constexpr int PADDED_SIZE = ChunkSection::SIZE + 2;
+    static constexpr int PADDED_VOLUME = PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+
+private:
+    std::vector<BlockId> _blocks;
+    std::vector<std::uint8_t> _light;
+    std::array<std::uint32_t, ChunkSection::AREA> _mask{};
+    // quads are sorted into these first, then copied into the mesh one pass after the other
+    std::array<MeshData::Vertices, RENDER_PASS_COUNT> _passVertices{};
+
+public:
+    Mesher();
+
+    // copies the section and its border out of the world. missing neighbours count as air in open sky.
+    void gather(const World &world, const glm::ivec3 &sectionPos);
+    // meshes the last gathered section into out, replacing its contents
+    void mesh(MeshData &out);
+
+    void mesh(const World &world, const glm::ivec3 &sectionPos, MeshData &out);
+
+    static int paddedIndex(int x, int y, int z) {
+        return ((y + 1) * PADDED_SIZE + (z + 1)) * PADDED_SIZE + (x + 1);
+    }
+
+private:
+    // adds the faces to _passVertices
+    void meshFace(int axis, bool positive, MeshData &out);
+};
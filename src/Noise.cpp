@@ -0,0 +1,113 @@
+#include "Noise.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "NoiseKernel.h"
+
+void Noise::Scalar::fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+    fbm2DGrid<ScalarOps>(octaves, originX, originZ, sizeX, sizeZ, out);
+}
+
+void Noise::Scalar::fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+    int sizeX, int sizeY, int sizeZ, float *out) {
+    fbm3DGrid<ScalarOps>(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out);
+}
+
+namespace {
+    Noise::Octaves makeOctaves(const Noise::FbmSettings &settings) {
+        if (settings.octaves < 1 || settings.octaves > Noise::MAX_OCTAVES) {
+            throw std::runtime_error("Noise octave count must be between 1 and " + std::to_string(Noise::MAX_OCTAVES));
+        }
+
+        Noise::Octaves octaves{};
+        octaves.count = settings.octaves;
+        float frequency = settings.frequency;
+        float amplitude = 1.0f;
+        float amplitudeSum = 0.0f;
+        for (int i = 0; i < settings.octaves; i++) {
+            // a different seed per octave keeps the octaves from lining up at the origin
+            octaves.seeds[i] = settings.seed + i * 1013;
+            octaves.frequencies[i] = frequency;
+            octaves.amplitudes[i] = amplitude;
+            amplitudeSum += amplitude;
+            frequency *= settings.lacunarity;
+            amplitude *= settings.gain;
+        }
+        octaves.scale = 1.0f / amplitudeSum;
+        return octaves;
+    }
+
+    bool cpuSupports(Noise::Isa isa) {
+#if defined(BLOCKGAME_NOISE_X86) && (defined(__GNUC__) || defined(__clang__))
+        switch (isa) {
+            case Noise::Isa::AVX2: return __builtin_cpu_supports("avx2");
+            case Noise::Isa::SSE41: return __builtin_cpu_supports("sse4.1");
+            default: return true;
+        }
+#else
+        return isa == Noise::Isa::SCALAR;
+#endif
+    }
+
+    void requireSupported(Noise::Isa isa) {
+        if (!Noise::isSupported(isa)) {
+            throw std::runtime_error(std::string("Noise instruction set ") + Noise::isaName(isa) + " is not supported on this CPU.");
+        }
+    }
+}
+
+Noise::Isa Noise::bestIsa() {
+    static const Isa best = isSupported(Isa::AVX2) ? Isa::AVX2 : isSupported(Isa::SSE41) ? Isa::SSE41 : Isa::SCALAR;
+    return best;
+}
+
+bool Noise::isSupported(Isa isa) {
+    return cpuSupports(isa);
+}
+
+const char *Noise::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::AVX2: return "AVX2";
+        case Isa::SSE41: return "SSE4.1";
+        default: return "scalar";
+    }
+}
+
+float Noise::simplex2D(int seed, float x, float y) {
+    return NoiseKernel<ScalarOps>::simplex2(seed, x, y);
+}
+
+float Noise::simplex3D(int seed, float x, float y, float z) {
+    return NoiseKernel<ScalarOps>::simplex3(seed, x, y, z);
+}
+
+void Noise::fbm2D(const FbmSettings &settings, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+    fbm2D(bestIsa(), settings, originX, originZ, sizeX, sizeZ, out);
+}
+
+void Noise::fbm3D(const FbmSettings &settings, int originX, int originY, int originZ,
+    int sizeX, int sizeY, int sizeZ, float *out) {
+    fbm3D(bestIsa(), settings, originX, originY, originZ, sizeX, sizeY, sizeZ, out);
+}
+
+void Noise::fbm2D(Isa isa, const FbmSettings &settings, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+    requireSupported(isa);
+    Octaves octaves = makeOctaves(settings);
+    switch (isa) {
+        case Isa::AVX2: Avx2::fbm2D(octaves, originX, originZ, sizeX, sizeZ, out); break;
+        case Isa::SSE41: Sse41::fbm2D(octaves, originX, originZ, sizeX, sizeZ, out); break;
+        default: Scalar::fbm2D(octaves, originX, originZ, sizeX, sizeZ, out); break;
+    }
+}
+
+void Noise::fbm3D(Isa isa, const FbmSettings &settings, int originX, int originY, int originZ,
+    int sizeX, int sizeY, int sizeZ, float *out) {
+    requireSupported(isa);
+    Octaves octaves = makeOctaves(settings);
+    switch (isa) {
+        case Isa::AVX2: Avx2::fbm3D(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out); break;
+        case Isa::SSE41: Sse41::fbm3D(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out); break;
+        default: Scalar::fbm3D(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out); break;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Simplex noise evaluated over whole grids of samples at once. Every instruction set produces exactly
+// the same bits, so terrain doesn't depend on which machine generated it.
+namespace Noise {
+    enum class Isa {
+        SCALAR,
+        SSE41,
+        AVX2
+    };
+
+    struct FbmSettings {
+        int seed{0};
+        int octaves{4};
+        // frequency of the first octave, in cycles per block
+        float frequency{1.0f / 64.0f};
+        float lacunarity{2.0f};
+        float gain{0.5f};
+    };
+
+    constexpr int MAX_OCTAVES = 16;
+
+    // the best instruction set this CPU supports
+    Isa bestIsa();
+    bool isSupported(Isa isa);
+    const char *isaName(Isa isa);
+
+    // single samples, roughly in [-1, 1]
+    float simplex2D(int seed, float x, float y);
+    float simplex3D(int seed, float x, float y, float z);
+
+    // Fractal noise over integer sample positions, normalized to roughly [-1, 1]. 2D output is indexed
+    // by [z * sizeX + x], 3D output by [(y * sizeZ + z) * sizeX + x], the same order as ChunkSection.
+    void fbm2D(const FbmSettings &settings, int originX, int originZ, int sizeX, int sizeZ, float *out);
+    void fbm3D(const FbmSettings &settings, int originX, int originY, int originZ,
+        int sizeX, int sizeY, int sizeZ, float *out);
+
+    // same as above, but forces a specific instruction set. throws if the CPU doesn't support it.
+    void fbm2D(Isa isa, const FbmSettings &settings, int originX, int originZ, int sizeX, int sizeZ, float *out);
+    void fbm3D(Isa isa, const FbmSettings &settings, int originX, int originY, int originZ,
+        int sizeX, int sizeY, int sizeZ, float *out);
+}
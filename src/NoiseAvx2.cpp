@@ -0,0 +1,70 @@
+#include "NoiseKernel.h"
+
+// compiled with -mavx2 on x86, see CMakeLists.txt
+#ifdef BLOCKGAME_NOISE_X86
+
+#include <immintrin.h>
+
+namespace {
+    struct Avx2Ops {
+        static constexpr int WIDTH = 8;
+        using Float = __m256;
+        using Int = __m256i;
+        using Mask = __m256;
+
+        static Float set(float value) { return _mm256_set1_ps(value); }
+        static Int seti(std::int32_t value) { return _mm256_set1_epi32(value); }
+        static Int laneIndices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+        static void store(float *out, Float value) { _mm256_storeu_ps(out, value); }
+
+        static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+        static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+        static Float floor(Float a) { return _mm256_floor_ps(a); }
+        static Mask lt(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static Mask ge(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static Float select(Mask mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+        static Mask andMask(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+        static Mask orMask(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+        static Mask notMask(Mask a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+
+        static Int toInt(Float a) { return _mm256_cvttps_epi32(a); }
+        static Float toFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+        static Int addi(Int a, Int b) { return _mm256_add_epi32(a, b); }
+        static Int muli(Int a, Int b) { return _mm256_mullo_epi32(a, b); }
+        static Int xori(Int a, Int b) { return _mm256_xor_si256(a, b); }
+        static Int andi(Int a, Int b) { return _mm256_and_si256(a, b); }
+        static Int srli(Int a, int shift) { return _mm256_srli_epi32(a, shift); }
+        static Int slli(Int a, int shift) { return _mm256_slli_epi32(a, shift); }
+        static Mask lti(Int a, Int b) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)); }
+        static Mask eqi(Int a, Int b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+
+        static Float flipSign(Float a, Int signBits) {
+            Int sign = _mm256_and_si256(signBits, _mm256_set1_epi32(static_cast<int>(0x80000000u)));
+            return _mm256_xor_ps(a, _mm256_castsi256_ps(sign));
+        }
+    };
+}
+
+void Noise::Avx2::fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+    fbm2DGrid<Avx2Ops>(octaves, originX, originZ, sizeX, sizeZ, out);
+}
+
+void Noise::Avx2::fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+    int sizeX, int sizeY, int sizeZ, float *out) {
+    fbm3DGrid<Avx2Ops>(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out);
+}
+
+#else
+
+// never selected at runtime on other architectures, but the dispatcher still needs something to call
+void Noise::Avx2::fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+    Scalar::fbm2D(octaves, originX, originZ, sizeX, sizeZ, out);
+}
+
+void Noise::Avx2::fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+    int sizeX, int sizeY, int sizeZ, float *out) {
+    Scalar::fbm3D(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out);
+}
+
+#endif
@@ -0,0 +1,293 @@
+#pragma once
+
+// The noise algorithm, written once against a small set of vector operations. Noise.cpp, NoiseSse41.cpp
+// and NoiseAvx2.cpp each instantiate it with their own vector type and compiler flags. Because all of
+// them perform the same float operations in the same order (and none of them are allowed to contract
+// into FMAs), every version returns exactly the same bits.
+
+#include <cstdint>
+#include <cstring>
+
+#include "Noise.h"
+
+namespace Noise {
+    // per-octave values, precomputed once so every instruction set uses the exact same floats
+    struct Octaves {
+        int count;
+        int seeds[MAX_OCTAVES];
+        float frequencies[MAX_OCTAVES];
+        float amplitudes[MAX_OCTAVES];
+        // 1 / sum of amplitudes
+        float scale;
+    };
+
+    namespace Scalar {
+        void fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out);
+        void fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+            int sizeX, int sizeY, int sizeZ, float *out);
+    }
+    namespace Sse41 {
+        void fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out);
+        void fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+            int sizeX, int sizeY, int sizeZ, float *out);
+    }
+    namespace Avx2 {
+        void fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out);
+        void fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+            int sizeX, int sizeY, int sizeZ, float *out);
+    }
+}
+
+// everything below is compiled differently by each including file, so it must not have external
+// linkage or the linker could pick, say, the AVX2 copy for the scalar path
+namespace {
+    struct ScalarOps {
+        static constexpr int WIDTH = 1;
+        using Float = float;
+        using Int = std::int32_t;
+        using Mask = bool;
+
+        static Float set(float value) { return value; }
+        static Int seti(std::int32_t value) { return value; }
+        static Int laneIndices() { return 0; }
+        static void store(float *out, Float value) { *out = value; }
+
+        static Float add(Float a, Float b) { return a + b; }
+        static Float sub(Float a, Float b) { return a - b; }
+        static Float mul(Float a, Float b) { return a * b; }
+        // not std::floor: that's an inline function every file emits its own copy of, and the linker
+        // could keep the one compiled for AVX2
+        static Float floor(Float a) { return __builtin_floorf(a); }
+        static Mask lt(Float a, Float b) { return a < b; }
+        static Mask ge(Float a, Float b) { return a >= b; }
+        static Float select(Mask mask, Float a, Float b) { return mask ? a : b; }
+        static Mask andMask(Mask a, Mask b) { return a && b; }
+        static Mask orMask(Mask a, Mask b) { return a || b; }
+        static Mask notMask(Mask a) { return !a; }
+
+        static Int toInt(Float a) { return static_cast<Int>(a); }
+        static Float toFloat(Int a) { return static_cast<Float>(a); }
+        // integer math wraps like the vector instructions do
+        static Int addi(Int a, Int b) { return static_cast<Int>(static_cast<std::uint32_t>(a) + static_cast<std::uint32_t>(b)); }
+        static Int muli(Int a, Int b) { return static_cast<Int>(static_cast<std::uint32_t>(a) * static_cast<std::uint32_t>(b)); }
+        static Int xori(Int a, Int b) { return a ^ b; }
+        static Int andi(Int a, Int b) { return a & b; }
+        static Int srli(Int a, int shift) { return static_cast<Int>(static_cast<std::uint32_t>(a) >> shift); }
+        static Int slli(Int a, int shift) { return static_cast<Int>(static_cast<std::uint32_t>(a) << shift); }
+        static Mask lti(Int a, Int b) { return a < b; }
+        static Mask eqi(Int a, Int b) { return a == b; }
+
+        // xors the sign bit with the top bit of signBits
+        static Float flipSign(Float a, Int signBits) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &a, sizeof(bits));
+            bits ^= static_cast<std::uint32_t>(signBits) & 0x80000000u;
+            std::memcpy(&a, &bits, sizeof(bits));
+            return a;
+        }
+    };
+
+    constexpr std::int32_t PRIME_X = 501125321;
+    constexpr std::int32_t PRIME_Y = 1136930381;
+    constexpr std::int32_t PRIME_Z = 1720413743;
+    constexpr std::int32_t HASH_MULTIPLIER = 0x27d4eb2d;
+
+    // skew factors: (sqrt(3) - 1) / 2, (3 - sqrt(3)) / 6, 1 / 3 and 1 / 6
+    constexpr float F2 = 0.366025403784f;
+    constexpr float G2 = 0.211324865405f;
+    constexpr float F3 = 1.0f / 3.0f;
+    constexpr float G3 = 1.0f / 6.0f;
+
+    template<typename V>
+    struct NoiseKernel {
+        using F = typename V::Float;
+        using I = typename V::Int;
+        using M = typename V::Mask;
+
+        static I finishHash(I hash) {
+            hash = V::muli(hash, V::seti(HASH_MULTIPLIER));
+            return V::xori(hash, V::srli(hash, 15));
+        }
+
+        static I hash2(I seed, I x, I y) {
+            return finishHash(V::xori(seed, V::xori(V::muli(x, V::seti(PRIME_X)), V::muli(y, V::seti(PRIME_Y)))));
+        }
+
+        static I hash3(I seed, I x, I y, I z) {
+            I hash = V::xori(V::muli(x, V::seti(PRIME_X)), V::muli(y, V::seti(PRIME_Y)));
+            return finishHash(V::xori(seed, V::xori(hash, V::muli(z, V::seti(PRIME_Z)))));
+        }
+
+        // one of 8 gradients, (+-1, +-2) and (+-2, +-1)
+        static F grad2(I hash, F x, F y) {
+            I h = V::andi(hash, V::seti(7));
+            M low = V::lti(h, V::seti(4));
+            F u = V::select(low, x, y);
+            F v = V::select(low, y, x);
+            return V::add(V::flipSign(u, V::slli(h, 31)), V::flipSign(V::add(v, v), V::slli(h, 30)));
+        }
+
+        // one of 12 gradients towards the edges of a cube, with 4 of them repeated
+        static F grad3(I hash, F x, F y, F z) {
+            I h = V::andi(hash, V::seti(15));
+            F u = V::select(V::lti(h, V::seti(8)), x, y);
+            M useX = V::orMask(V::eqi(h, V::seti(12)), V::eqi(h, V::seti(14)));
+            F v = V::select(V::lti(h, V::seti(4)), y, V::select(useX, x, z));
+            return V::add(V::flipSign(u, V::slli(h, 31)), V::flipSign(v, V::slli(h, 30)));
+        }
+
+        // contribution of a single corner: max(0, falloff - d^2)^4 * gradient
+        static F corner(F falloff, F distanceSquared, F gradient) {
+            F t = V::sub(falloff, distanceSquared);
+            t = V::select(V::lt(t, V::set(0.0f)), V::set(0.0f), t);
+            t = V::mul(t, t);
+            return V::mul(V::mul(t, t), gradient);
+        }
+
+        static F one(M mask) {
+            return V::select(mask, V::set(1.0f), V::set(0.0f));
+        }
+
+        static F simplex2(I seed, F x, F y) {
+            F s = V::mul(V::add(x, y), V::set(F2));
+            F fi = V::floor(V::add(x, s));
+            F fj = V::floor(V::add(y, s));
+            F t = V::mul(V::add(fi, fj), V::set(G2));
+            F x0 = V::sub(x, V::sub(fi, t));
+            F y0 = V::sub(y, V::sub(fj, t));
+            I i = V::toInt(fi);
+            I j = V::toInt(fj);
+
+            // which of the two triangles of the skewed cell we are in
+            M lower = V::ge(x0, y0);
+            F i1 = one(lower);
+            F j1 = one(V::notMask(lower));
+
+            F x1 = V::add(V::sub(x0, i1), V::set(G2));
+            F y1 = V::add(V::sub(y0, j1), V::set(G2));
+            F x2 = V::add(V::sub(x0, V::set(1.0f)), V::set(2.0f * G2));
+            F y2 = V::add(V::sub(y0, V::set(1.0f)), V::set(2.0f * G2));
+
+            I h0 = hash2(seed, i, j);
+            I h1 = hash2(seed, V::addi(i, V::toInt(i1)), V::addi(j, V::toInt(j1)));
+            I h2 = hash2(seed, V::addi(i, V::seti(1)), V::addi(j, V::seti(1)));
+
+            F n0 = corner(V::set(0.5f), V::add(V::mul(x0, x0), V::mul(y0, y0)), grad2(h0, x0, y0));
+            F n1 = corner(V::set(0.5f), V::add(V::mul(x1, x1), V::mul(y1, y1)), grad2(h1, x1, y1));
+            F n2 = corner(V::set(0.5f), V::add(V::mul(x2, x2), V::mul(y2, y2)), grad2(h2, x2, y2));
+            return V::mul(V::set(40.0f), V::add(V::add(n0, n1), n2));
+        }
+
+        static F simplex3(I seed, F x, F y, F z) {
+            F s = V::mul(V::add(V::add(x, y), z), V::set(F3));
+            F fi = V::floor(V::add(x, s));
+            F fj = V::floor(V::add(y, s));
+            F fk = V::floor(V::add(z, s));
+            F t = V::mul(V::add(V::add(fi, fj), fk), V::set(G3));
+            F x0 = V::sub(x, V::sub(fi, t));
+            F y0 = V::sub(y, V::sub(fj, t));
+            F z0 = V::sub(z, V::sub(fk, t));
+            I i = V::toInt(fi);
+            I j = V::toInt(fj);
+            I k = V::toInt(fk);
+
+            // rank the offsets to find which of the six tetrahedra we are in. the first corner steps
+            // along the largest axis, the second along every axis but the smallest.
+            M xy = V::ge(x0, y0);
+            M yz = V::ge(y0, z0);
+            M xz = V::ge(x0, z0);
+            F i1 = one(V::andMask(xy, xz));
+            F j1 = one(V::andMask(V::notMask(xy), yz));
+            F k1 = one(V::andMask(V::notMask(xz), V::notMask(yz)));
+            F i2 = one(V::orMask(xy, xz));
+            F j2 = one(V::orMask(V::notMask(xy), yz));
+            F k2 = one(V::orMask(V::notMask(xz), V::notMask(yz)));
+
+            F x1 = V::add(V::sub(x0, i1), V::set(G3));
+            F y1 = V::add(V::sub(y0, j1), V::set(G3));
+            F z1 = V::add(V::sub(z0, k1), V::set(G3));
+            F x2 = V::add(V::sub(x0, i2), V::set(2.0f * G3));
+            F y2 = V::add(V::sub(y0, j2), V::set(2.0f * G3));
+            F z2 = V::add(V::sub(z0, k2), V::set(2.0f * G3));
+            F x3 = V::add(V::sub(x0, V::set(1.0f)), V::set(3.0f * G3));
+            F y3 = V::add(V::sub(y0, V::set(1.0f)), V::set(3.0f * G3));
+            F z3 = V::add(V::sub(z0, V::set(1.0f)), V::set(3.0f * G3));
+
+            I step = V::seti(1);
+            I h0 = hash3(seed, i, j, k);
+            I h1 = hash3(seed, V::addi(i, V::toInt(i1)), V::addi(j, V::toInt(j1)), V::addi(k, V::toInt(k1)));
+            I h2 = hash3(seed, V::addi(i, V::toInt(i2)), V::addi(j, V::toInt(j2)), V::addi(k, V::toInt(k2)));
+            I h3 = hash3(seed, V::addi(i, step), V::addi(j, step), V::addi(k, step));
+
+            F n0 = corner(V::set(0.6f), lengthSquared(x0, y0, z0), grad3(h0, x0, y0, z0));
+            F n1 = corner(V::set(0.6f), lengthSquared(x1, y1, z1), grad3(h1, x1, y1, z1));
+            F n2 = corner(V::set(0.6f), lengthSquared(x2, y2, z2), grad3(h2, x2, y2, z2));
+            F n3 = corner(V::set(0.6f), lengthSquared(x3, y3, z3), grad3(h3, x3, y3, z3));
+            return V::mul(V::set(32.0f), V::add(V::add(n0, n1), V::add(n2, n3)));
+        }
+
+        static F lengthSquared(F x, F y, F z) {
+            return V::add(V::add(V::mul(x, x), V::mul(y, y)), V::mul(z, z));
+        }
+
+        static F fbm2(const Noise::Octaves &octaves, F x, F y) {
+            F sum = V::set(0.0f);
+            for (int o = 0; o < octaves.count; o++) {
+                F frequency = V::set(octaves.frequencies[o]);
+                F value = simplex2(V::seti(octaves.seeds[o]), V::mul(x, frequency), V::mul(y, frequency));
+                sum = V::add(sum, V::mul(value, V::set(octaves.amplitudes[o])));
+            }
+            return V::mul(sum, V::set(octaves.scale));
+        }
+
+        static F fbm3(const Noise::Octaves &octaves, F x, F y, F z) {
+            F sum = V::set(0.0f);
+            for (int o = 0; o < octaves.count; o++) {
+                F frequency = V::set(octaves.frequencies[o]);
+                F value = simplex3(V::seti(octaves.seeds[o]),
+                    V::mul(x, frequency), V::mul(y, frequency), V::mul(z, frequency));
+                sum = V::add(sum, V::mul(value, V::set(octaves.amplitudes[o])));
+            }
+            return V::mul(sum, V::set(octaves.scale));
+        }
+    };
+
+    // walks a row of samples WIDTH at a time and finishes the remainder one sample at a time
+    template<typename V, typename Sample>
+    void forEachInRow(int originX, int sizeX, float *out, Sample sample) {
+        int x = 0;
+        for (; x + V::WIDTH <= sizeX; x += V::WIDTH) {
+            auto position = V::toFloat(V::addi(V::seti(originX + x), V::laneIndices()));
+            V::store(out + x, sample(V(), position));
+        }
+        for (; x < sizeX; x++) {
+            out[x] = sample(ScalarOps(), ScalarOps::toFloat(originX + x));
+        }
+    }
+
+    template<typename V>
+    void fbm2DGrid(const Noise::Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+        for (int z = 0; z < sizeZ; z++) {
+            auto fz = static_cast<float>(originZ + z);
+            forEachInRow<V>(originX, sizeX, out + z * sizeX, [&](auto ops, auto x) {
+                using Ops = decltype(ops);
+                return NoiseKernel<Ops>::fbm2(octaves, x, Ops::set(fz));
+            });
+        }
+    }
+
+    template<typename V>
+    void fbm3DGrid(const Noise::Octaves &octaves, int originX, int originY, int originZ,
+        int sizeX, int sizeY, int sizeZ, float *out) {
+        for (int y = 0; y < sizeY; y++) {
+            auto fy = static_cast<float>(originY + y);
+            for (int z = 0; z < sizeZ; z++) {
+                auto fz = static_cast<float>(originZ + z);
+                forEachInRow<V>(originX, sizeX, out + (y * sizeZ + z) * sizeX, [&](auto ops, auto x) {
+                    using Ops = decltype(ops);
+                    return NoiseKernel<Ops>::fbm3(octaves, x, Ops::set(fy), Ops::set(fz));
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#include "NoiseKernel.h"
+
+// compiled with -msse4.1 on x86, see CMakeLists.txt
+#ifdef BLOCKGAME_NOISE_X86
+
+#include <smmintrin.h>
+
+namespace {
+    struct Sse41Ops {
+        static constexpr int WIDTH = 4;
+        using Float = __m128;
+        using Int = __m128i;
+        using Mask = __m128;
+
+        static Float set(float value) { return _mm_set1_ps(value); }
+        static Int seti(std::int32_t value) { return _mm_set1_epi32(value); }
+        static Int laneIndices() { return _mm_setr_epi32(0, 1, 2, 3); }
+        static void store(float *out, Float value) { _mm_storeu_ps(out, value); }
+
+        static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+        static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+        static Float floor(Float a) { return _mm_floor_ps(a); }
+        static Mask lt(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+        static Mask ge(Float a, Float b) { return _mm_cmpge_ps(a, b); }
+        static Float select(Mask mask, Float a, Float b) { return _mm_blendv_ps(b, a, mask); }
+        static Mask andMask(Mask a, Mask b) { return _mm_and_ps(a, b); }
+        static Mask orMask(Mask a, Mask b) { return _mm_or_ps(a, b); }
+        static Mask notMask(Mask a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+
+        static Int toInt(Float a) { return _mm_cvttps_epi32(a); }
+        static Float toFloat(Int a) { return _mm_cvtepi32_ps(a); }
+        static Int addi(Int a, Int b) { return _mm_add_epi32(a, b); }
+        static Int muli(Int a, Int b) { return _mm_mullo_epi32(a, b); }
+        static Int xori(Int a, Int b) { return _mm_xor_si128(a, b); }
+        static Int andi(Int a, Int b) { return _mm_and_si128(a, b); }
+        static Int srli(Int a, int shift) { return _mm_srli_epi32(a, shift); }
+        static Int slli(Int a, int shift) { return _mm_slli_epi32(a, shift); }
+        static Mask lti(Int a, Int b) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, b)); }
+        static Mask eqi(Int a, Int b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+
+        static Float flipSign(Float a, Int signBits) {
+            Int sign = _mm_and_si128(signBits, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+            return _mm_xor_ps(a, _mm_castsi128_ps(sign));
+        }
+    };
+}
+
+void Noise::Sse41::fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+    fbm2DGrid<Sse41Ops>(octaves, originX, originZ, sizeX, sizeZ, out);
+}
+
+void Noise::Sse41::fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+    int sizeX, int sizeY, int sizeZ, float *out) {
+    fbm3DGrid<Sse41Ops>(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out);
+}
+
+#else
+
+// never selected at runtime on other architectures, but the dispatcher still needs something to call
+void Noise::Sse41::fbm2D(const Octaves &octaves, int originX, int originZ, int sizeX, int sizeZ, float *out) {
+    Scalar::fbm2D(octaves, originX, originZ, sizeX, sizeZ, out);
+}
+
+void Noise::Sse41::fbm3D(const Octaves &octaves, int originX, int originY, int originZ,
+    int sizeX, int sizeY, int sizeZ, float *out) {
+    Scalar::fbm3D(octaves, originX, originY, originZ, sizeX, sizeY, sizeZ, out);
+}
+
+#endif
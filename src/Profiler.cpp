@@ -0,0 +1,184 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    struct Event {
+        const char *name;
+        std::int64_t start;
+        std::int64_t end;
+    };
+}
+
+// only one thread records into a track. the writer only reads the first count events, which are never
+// touched again in the same capture.
+struct Profiler::Track {
+    unsigned int id{0};
+    // guarded by registryMutex
+    std::string name{};
+    // allocated by the first zone, so threads that never record don't pay for it
+    std::unique_ptr<Event[]> events{};
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::size_t> dropped{0};
+    // the capture count and dropped belong to. the recording thread resets them when a new one starts.
+    std::atomic<std::uint32_t> capture{0};
+};
+
+namespace {
+    using Profiler::Track;
+
+    std::mutex registryMutex;
+    // never shrinks, so tracks of threads that are gone still end up in the trace
+    std::vector<std::unique_ptr<Track>> tracks;
+    std::atomic<std::uint32_t> currentCapture{0};
+    std::atomic<std::int64_t> captureStart{0};
+
+    thread_local Track *threadTrack = nullptr;
+
+    std::int64_t clockNanoseconds() {
+        auto time = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    }
+
+    Track &addTrack(const std::string &name) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto track = std::make_unique<Track>();
+        track->id = static_cast<unsigned int>(tracks.size());
+        track->name = name.empty() ? "thread " + std::to_string(track->id) : name;
+        tracks.push_back(std::move(track));
+        return *tracks.back();
+    }
+
+    Track &ownTrack() {
+        if (threadTrack == nullptr) {
+            threadTrack = &addTrack("");
+        }
+        return *threadTrack;
+    }
+
+    void writeString(std::ostream &out, const std::string &string) {
+        out << '"';
+        for (char c : string) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << ' ';
+            } else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    // trace events are in microseconds
+    void writeMicroseconds(std::ostream &out, std::int64_t nanoseconds) {
+        out << nanoseconds / 1000 << '.';
+        auto fraction = nanoseconds % 1000;
+        out << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10)
+            << static_cast<char>('0' + fraction % 10);
+    }
+}
+
+namespace Profiler {
+    std::int64_t now() {
+        return clockNanoseconds() - captureStart.load(std::memory_order_relaxed);
+    }
+
+    void record(const char *name, std::int64_t start, std::int64_t end) {
+        record(ownTrack(), name, start, end);
+    }
+
+    Track &createTrack(const std::string &name) {
+        return addTrack(name);
+    }
+
+    void record(Track &track, const char *name, std::int64_t start, std::int64_t end) {
+        // started in a capture that was stopped and restarted before the zone ended
+        if (start < 0 || end < start) {
+            return;
+        }
+        auto capture = currentCapture.load(std::memory_order_acquire);
+        if (track.capture.load(std::memory_order_relaxed) != capture) {
+            track.count.store(0, std::memory_order_relaxed);
+            track.dropped.store(0, std::memory_order_relaxed);
+            track.capture.store(capture, std::memory_order_release);
+        }
+        if (!track.events) {
+            track.events = std::make_unique<Event[]>(EVENTS_PER_TRACK);
+        }
+
+        auto index = track.count.load(std::memory_order_relaxed);
+        if (index >= EVENTS_PER_TRACK) {
+            track.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        track.events[index] = {name, start, end};
+        track.count.store(index + 1, std::memory_order_release);
+    }
+
+    void start() {
+        captureStart.store(clockNanoseconds(), std::memory_order_relaxed);
+        currentCapture.fetch_add(1, std::memory_order_release);
+        capturing.store(true, std::memory_order_release);
+    }
+
+    void stop() {
+        capturing.store(false, std::memory_order_release);
+    }
+
+    TraceStats writeChromeTrace(const std::string &path) {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Could not write trace '" + path + "'");
+        }
+
+        TraceStats stats;
+        auto capture = currentCapture.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto &track : tracks) {
+            if (track->capture.load(std::memory_order_acquire) != capture) {
+                continue;
+            }
+            auto count = track->count.load(std::memory_order_acquire);
+            stats.events += count;
+            stats.dropped += track->dropped.load(std::memory_order_relaxed);
+            stats.tracks++;
+
+            out << (first ? "" : ",\n") << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << track->id
+                << R"(,"args":{"name":)";
+            writeString(out, track->name);
+            out << "}}";
+            first = false;
+
+            for (std::size_t i = 0; i < count; i++) {
+                const Event &event = track->events[i];
+                out << ",\n{\"name\":";
+                writeString(out, event.name);
+                out << R"(,"ph":"X","pid":1,"tid":)" << track->id << ",\"ts\":";
+                writeMicroseconds(out, event.start);
+                out << ",\"dur\":";
+                writeMicroseconds(out, event.end - event.start);
+                out << '}';
+            }
+        }
+        out << "\n]}\n";
+
+        if (!out) {
+            throw std::runtime_error("Could not write trace '" + path + "'");
+        }
+        return stats;
+    }
+
+    void setThreadName(const std::string &name) {
+        Track &track = ownTrack();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        track.name = name;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Records how long scoped zones take on every thread, to be looked at as a Chrome trace (chrome://tracing or
+// ui.perfetto.dev). Nothing is recorded until a capture is started, and a zone outside of one costs a
+// single relaxed load.
+//
+// Every thread writes its zones to a track of its own, so recording never locks. A capture only adds up to
+// EVENTS_PER_TRACK zones a track; the rest are counted as dropped.
+namespace Profiler {
+    constexpr std::size_t EVENTS_PER_TRACK = 1 << 16;
+
+    struct Track;
+
+    struct TraceStats {
+        std::size_t events{0};
+        std::size_t dropped{0};
+        std::size_t tracks{0};
+    };
+
+    // read by every zone, use isCapturing
+    inline std::atomic<bool> capturing{false};
+
+    // acquire so the capture's start time is seen too. that's still a plain load on x86.
+    inline bool isCapturing() {
+        return capturing.load(std::memory_order_acquire);
+    }
+
+    // nanoseconds since the capture started
+    std::int64_t now();
+    // called by Zone, name has to live until the trace is written
+    void record(const char *name, std::int64_t start, std::int64_t end);
+
+    // a track of its own, for work that isn't timed on the thread that records it, like the GPU's. tracks are
+    // never freed, so make one for good. only one thread may record to it at a time.
+    Track &createTrack(const std::string &name);
+    // start and end are like now(), events that start before the capture are left out
+    void record(Track &track, const char *name, std::int64_t start, std::int64_t end);
+
+    // times the scope it's declared in. name should be a string literal.
+    class Zone {
+    private:
+        const char *_name;
+        std::int64_t _start;
+
+    public:
+        explicit Zone(const char *name) : _name(name), _start(isCapturing() ? now() : -1) {}
+
+        ~Zone() {
+            // zones that started before the capture or end after it are left out
+            if (_start >= 0 && isCapturing()) {
+                record(_name, _start, now());
+            }
+        }
+
+        Zone(const Zone &other) = delete;
+        Zone &operator=(const Zone &other) = delete;
+    };
+
+    // forgets the zones of the last capture
+    void start();
+    void stop();
+    // of the last capture, which should be stopped first. throws if the file can't be written.
+    TraceStats writeChromeTrace(const std::string &path);
+
+    // shown instead of "thread n" in the trace
+    void setThreadName(const std::string &name);
+}
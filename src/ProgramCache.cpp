@@ -0,0 +1,148 @@
+#include "ProgramCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    // glad is generated for plain 3.3, so the extension is loaded by hand
+    constexpr GLenum PROGRAM_BINARY_RETRIEVABLE_HINT = 0x8257;
+    constexpr GLenum PROGRAM_BINARY_LENGTH = 0x8741;
+    constexpr GLenum NUM_PROGRAM_BINARY_FORMATS = 0x87FE;
+    typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei *length,
+        GLenum *binaryFormat, void *binary);
+    typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void *binary,
+        GLsizei length);
+    typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+    GetProgramBinaryProc getProgramBinary = nullptr;
+    ProgramBinaryProc programBinary = nullptr;
+    ProgramParameteriProc programParameteri = nullptr;
+
+    bool loadProgramBinary() {
+        if (!GLExtensions::isSupported("GL_ARB_get_program_binary")) {
+            return false;
+        }
+        getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(GLExtensions::procAddress("glGetProgramBinary"));
+        programBinary = reinterpret_cast<ProgramBinaryProc>(GLExtensions::procAddress("glProgramBinary"));
+        programParameteri = reinterpret_cast<ProgramParameteriProc>(
+            GLExtensions::procAddress("glProgramParameteri"));
+        // some drivers have the extension but no formats to save in
+        GLint formats = 0;
+        glGetIntegerv(NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return getProgramBinary && programBinary && programParameteri && formats > 0;
+    }
+
+    // FNV-1a
+    constexpr std::uint64_t HASH_OFFSET = 14695981039346656037ull;
+    constexpr std::uint64_t HASH_PRIME = 1099511628211ull;
+
+    std::uint64_t hash(std::uint64_t hash, const char *string) {
+        // the terminator is hashed too, so "ab" + "c" and "a" + "bc" don't collide
+        for (const char *c = string; ; c++) {
+            hash = (hash ^ static_cast<unsigned char>(*c)) * HASH_PRIME;
+            if (*c == '\0') {
+                return hash;
+            }
+        }
+    }
+
+    const char *glString(GLenum name) {
+        auto string = reinterpret_cast<const char *>(glGetString(name));
+        return string ? string : "";
+    }
+}
+
+ProgramCache::ProgramCache(const std::string &directory) : _directory(directory) {
+    if (!loadProgramBinary()) {
+        return;
+    }
+    // a cache that can't be written to just never has anything in it
+    std::error_code error;
+    fs::create_directories(directory, error);
+    _supported = true;
+    _driverHash = hash(hash(hash(HASH_OFFSET, glString(GL_VENDOR)), glString(GL_RENDERER)), glString(GL_VERSION));
+}
+
+bool ProgramCache::isSupported() const {
+    return _supported;
+}
+
+std::uint64_t ProgramCache::key(const char *vertexSource, const char *fragmentSource) const {
+    return hash(hash(_driverHash, vertexSource), fragmentSource);
+}
+
+bool ProgramCache::load(unsigned int program, std::uint64_t key) const {
+    if (!isSupported()) {
+        return false;
+    }
+    std::ifstream file(path(key), std::ios::binary);
+    GLenum format;
+    if (!file.read(reinterpret_cast<char *>(&format), sizeof(format))) {
+        return false;
+    }
+    std::vector<char> binary{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (binary.empty()) {
+        return false;
+    }
+
+    programBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // usually a driver update. it gets replaced once the program is linked from source again.
+        file.close();
+        std::error_code error;
+        fs::remove(path(key), error);
+    }
+    return success;
+}
+
+void ProgramCache::prepare(unsigned int program) const {
+    if (isSupported()) {
+        programParameteri(program, PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void ProgramCache::save(unsigned int program, std::uint64_t key) const {
+    if (!isSupported()) {
+        return;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format;
+    getProgramBinary(program, length, &length, &format, binary.data());
+
+    // written next to the real file first, so a crash never leaves half a binary behind
+    std::string finalPath = path(key);
+    std::string temporaryPath = finalPath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&format), sizeof(format));
+        file.write(binary.data(), length);
+        if (!file) {
+            return;
+        }
+    }
+    std::error_code error;
+    fs::rename(temporaryPath, finalPath, error);
+}
+
+std::string ProgramCache::path(std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (fs::path(_directory) / name).string();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Keeps linked shader programs on disk with ARB_get_program_binary, so later runs can skip compiling and
+// linking. Each program is stored under a hash of its sources and the driver's vendor, renderer and version
+// strings, since a binary is only good for the exact driver that made it. Needs a current OpenGL context.
+class ProgramCache {
+private:
+    std::string _directory;
+    // false if the driver can't save binaries, then nothing is cached
+    bool _supported{false};
+    std::uint64_t _driverHash{0};
+
+public:
+    explicit ProgramCache(const std::string &directory);
+
+    bool isSupported() const;
+    // identifies a program made from these sources by this driver
+    std::uint64_t key(const char *vertexSource, const char *fragmentSource) const;
+
+    // loads the cached binary into a program made with glCreateProgram. returns false if there is none or
+    // the driver rejected it, the program has to be compiled and linked as usual then.
+    bool load(unsigned int program, std::uint64_t key) const;
+    // call before linking a program that will be saved
+    void prepare(unsigned int program) const;
+    void save(unsigned int program, std::uint64_t key) const;
+
+private:
+    std::string path(std::uint64_t key) const;
+};
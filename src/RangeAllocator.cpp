@@ -0,0 +1,90 @@
+#include "RangeAllocator.h"
+
+#include <iterator>
+#include <stdexcept>
+
+RangeAllocator::RangeAllocator(std::uint32_t capacity) : _capacity(capacity) {
+    clear();
+}
+
+bool RangeAllocator::allocate(std::uint32_t size, std::uint32_t &offset) {
+    if (size == 0) {
+        throw std::runtime_error("Could not allocate range: size is 0");
+    }
+    auto best = _freeBySize.lower_bound({size, 0});
+    if (best == _freeBySize.end()) {
+        return false;
+    }
+    auto [rangeSize, rangeOffset] = *best;
+    removeFree(_free.find(rangeOffset));
+    if (rangeSize > size) {
+        addFree(rangeOffset + size, rangeSize - size);
+    }
+    offset = rangeOffset;
+    _used += size;
+    return true;
+}
+
+void RangeAllocator::free(std::uint32_t offset, std::uint32_t size) {
+    _used -= size;
+
+    // merge with the free ranges right before and after, if there are any
+    auto next = _free.lower_bound(offset);
+    if (next != _free.end() && next->first == offset + size) {
+        size += next->second;
+        next = std::next(next);
+        removeFree(std::prev(next));
+    }
+    if (next != _free.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            removeFree(previous);
+        }
+    }
+    addFree(offset, size);
+}
+
+void RangeAllocator::clear() {
+    _free.clear();
+    _freeBySize.clear();
+    _used = 0;
+    if (_capacity > 0) {
+        addFree(0, _capacity);
+    }
+}
+
+std::uint32_t RangeAllocator::capacity() const {
+    return _capacity;
+}
+
+std::uint32_t RangeAllocator::used() const {
+    return _used;
+}
+
+std::uint32_t RangeAllocator::freeRangeCount() const {
+    return static_cast<std::uint32_t>(_free.size());
+}
+
+std::uint32_t RangeAllocator::largestFreeRange() const {
+    return _freeBySize.empty() ? 0 : _freeBySize.rbegin()->first;
+}
+
+float RangeAllocator::fragmentation() const {
+    std::uint32_t freeSpace = _capacity - _used;
+    if (freeSpace == 0) {
+        return 0.0f;
+    }
+    return 1.0f - static_cast<float>(largestFreeRange()) / static_cast<float>(freeSpace);
+}
+
+void RangeAllocator::addFree(std::uint32_t offset, std::uint32_t size) {
+    _free.emplace(offset, size);
+    _freeBySize.emplace(size, offset);
+}
+
+void RangeAllocator::removeFree(std::map<std::uint32_t, std::uint32_t>::iterator range) {
+    _freeBySize.erase({range->second, range->first});
+    _free.erase(range);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+
+// Hands out ranges of a fixed size space, like slots in a GPU buffer. Free ranges are kept sorted both by
+// where they are, so freeing can merge a range with its neighbours, and by size, so allocating can pick
+// the smallest range that fits.
+class RangeAllocator {
+private:
+    std::uint32_t _capacity;
+    std::uint32_t _used{0};
+    // offset to size
+    std::map<std::uint32_t, std::uint32_t> _free{};
+    // size and offset
+    std::set<std::pair<std::uint32_t, std::uint32_t>> _freeBySize{};
+
+public:
+    explicit RangeAllocator(std::uint32_t capacity);
+
+    // returns false if no free range is big enough
+    bool allocate(std::uint32_t size, std::uint32_t &offset);
+    // size has to be what the range was allocated with
+    void free(std::uint32_t offset, std::uint32_t size);
+    // forgets every allocation
+    void clear();
+
+    std::uint32_t capacity() const;
+    std::uint32_t used() const;
+    std::uint32_t freeRangeCount() const;
+    std::uint32_t largestFreeRange() const;
+    // 0 when all free space is in one range, close to 1 when it's scattered over many small ones
+    float fragmentation() const;
+
+private:
+    void addFree(std::uint32_t offset, std::uint32_t size);
+    void removeFree(std::map<std::uint32_t, std::uint32_t>::iterator range);
+};
@@ -0,0 +1,101 @@
+#include "Raycast.h"
+
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+
+#include <glm/geometric.hpp>
+
+#include "ChunkSection.h"
+#include "JobSystem.h"
+#include "World.h"
+
+namespace {
+    constexpr int HEIGHT = World::COLUMN_SECTIONS * ChunkSection::SIZE;
+
+    bool stops(BlockId block, Raycast::Filter filter) {
+        return filter == Raycast::Filter::SOLID ? block != Blocks::AIR : Blocks::info(block).opaque;
+    }
+}
+
+glm::ivec3 Raycast::normal(BlockFace face) {
+    glm::ivec3 result(0, 0, 0);
+    int axis = static_cast<int>(face) / 2;
+    result[axis] = static_cast<int>(face) % 2 == 0 ? -1 : 1;
+    return result;
+}
+
+Raycast::Hit Raycast::cast(const World &world, const Ray &ray, Filter filter) {
+    Hit hit{};
+    float length = glm::length(ray.direction);
+    if (length == 0.0f) {
+        return hit;
+    }
+    glm::vec3 direction = ray.direction / length;
+
+    // tMax is how far along the ray the next boundary on each axis is, tDelta how far apart they are
+    glm::ivec3 pos(std::floor(ray.origin.x), std::floor(ray.origin.y), std::floor(ray.origin.z));
+    glm::ivec3 step(0, 0, 0);
+    glm::vec3 tMax(std::numeric_limits<float>::infinity());
+    glm::vec3 tDelta(std::numeric_limits<float>::infinity());
+    for (int axis = 0; axis < 3; axis++) {
+        if (direction[axis] > 0.0f) {
+            step[axis] = 1;
+            tDelta[axis] = 1.0f / direction[axis];
+            tMax[axis] = (static_cast<float>(pos[axis] + 1) - ray.origin[axis]) * tDelta[axis];
+        } else if (direction[axis] < 0.0f) {
+            step[axis] = -1;
+            tDelta[axis] = -1.0f / direction[axis];
+            tMax[axis] = (ray.origin[axis] - static_cast<float>(pos[axis])) * tDelta[axis];
+        }
+    }
+
+    // a ray usually crosses many blocks per section, so the section is only looked up when it changes
+    glm::ivec3 sectionPos(pos.x >> 4, pos.y >> 4, pos.z >> 4);
+    const ChunkSection *section = world.getSection(sectionPos);
+
+    // a ray starting inside a block hits it through the face it mostly points away from
+    int axis = std::abs(direction.x) > std::abs(direction.y)
+        ? (std::abs(direction.x) > std::abs(direction.z) ? 0 : 2)
+        : (std::abs(direction.y) > std::abs(direction.z) ? 1 : 2);
+    float distance = 0.0f;
+    while (distance <= ray.maxDistance) {
+        if (pos.y >= 0 && pos.y < HEIGHT) {
+            glm::ivec3 currentSection(pos.x >> 4, pos.y >> 4, pos.z >> 4);
+            if (currentSection != sectionPos) {
+                sectionPos = currentSection;
+                section = world.getSection(sectionPos);
+            }
+            BlockId block = section ? section->get(pos.x & 15, pos.y & 15, pos.z & 15) : Blocks::AIR;
+            if (stops(block, filter)) {
+                hit.hit = true;
+                hit.pos = pos;
+                hit.block = block;
+                hit.face = static_cast<BlockFace>(axis * 2 + (step[axis] > 0 ? 0 : 1));
+                hit.distance = distance;
+                return hit;
+            }
+        } else if ((pos.y < 0 && step.y <= 0) || (pos.y >= HEIGHT && step.y >= 0)) {
+            // outside the world and not coming back
+            break;
+        }
+
+        axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+        distance = tMax[axis];
+        pos[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+    }
+    return hit;
+}
+
+void Raycast::castAll(const World &world, const std::vector<Ray> &rays, std::vector<Hit> &out, JobSystem &jobs,
+    Filter filter) {
+    out.resize(rays.size());
+    jobs.parallelFor(rays.size(), BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+        std::shared_lock<std::shared_mutex> lock(world.mutex());
+        for (std::size_t i = begin; i < end; i++) {
+            out[i] = cast(world, rays[i], filter);
+        }
+    });
+}
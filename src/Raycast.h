@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "Block.h"
+
+class JobSystem;
+class World;
+
+// Voxel traversal (Amanatides & Woo): a ray visits every block it passes through in order, one step per
+// block boundary crossed, so nothing is skipped and nothing is visited twice. Missing sections are air.
+namespace Raycast {
+    // rays are spread over the job system in groups of this many
+    constexpr std::size_t BATCH_SIZE = 64;
+
+    enum class Filter {
+        // stops at anything but air, for picking blocks
+        SOLID,
+        // only stops at blocks you can't see through, for line of sight
+        OPAQUE
+    };
+
+    struct Ray {
+        glm::vec3 origin;
+        // doesn't have to be normalized
+        glm::vec3 direction;
+        // in blocks
+        float maxDistance;
+    };
+
+    struct Hit {
+        bool hit{false};
+        glm::ivec3 pos{0, 0, 0};
+        BlockId block{Blocks::AIR};
+        // the face the ray went in through, so a block placed against it goes at pos + normal(face)
+        BlockFace face{BlockFace::POS_Y};
+        float distance{0.0f};
+    };
+
+    glm::ivec3 normal(BlockFace face);
+
+    // the world's mutex has to be held at least shared
+    Hit cast(const World &world, const Ray &ray, Filter filter = Filter::SOLID);
+    // casts every ray over the job system and puts ray i's hit in out[i]. takes the world's mutex shared
+    // itself, so it must not be held by the caller.
+    void castAll(const World &world, const std::vector<Ray> &rays, std::vector<Hit> &out, JobSystem &jobs,
+        Filter filter = Filter::SOLID);
+}
@@ -0,0 +1,145 @@
+#include "RegionFile.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace {
+    std::uint32_t readUint32(const std::uint8_t *data) {
+        return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8)
+            | (static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+    }
+
+    void writeUint32(std::uint8_t *data, std::uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            data[i] = static_cast<std::uint8_t>(value >> (i * 8));
+        }
+    }
+}
+
+RegionFile::RegionFile(const std::string &path) : _file(path) {
+    if (_file.size() < HEADER_SIZE) {
+        std::vector<std::uint8_t> header(HEADER_SECTORS * SECTOR_SIZE, 0);
+        _file.write(0, header.data(), header.size());
+    }
+
+    std::size_t fileSectors = _file.size() / SECTOR_SIZE;
+    _usedSectors.assign(std::max(fileSectors, HEADER_SECTORS), false);
+    std::fill(_usedSectors.begin(), _usedSectors.begin() + HEADER_SECTORS, true);
+
+    const std::uint8_t *header = _file.data();
+    for (int i = 0; i < COLUMNS; i++) {
+        Entry entry{readUint32(header + i * sizeof(Entry)), readUint32(header + i * sizeof(Entry) + 4)};
+        std::size_t sectors = sectorsFor(entry.length);
+        // anything pointing into the header or past the end of the file is treated as never saved
+        if (entry.length == 0 || entry.firstSector < HEADER_SECTORS || entry.firstSector + sectors > fileSectors) {
+            continue;
+        }
+        _entries[i] = entry;
+        std::fill(_usedSectors.begin() + entry.firstSector, _usedSectors.begin() + entry.firstSector + sectors, true);
+    }
+}
+
+bool RegionFile::contains(int localX, int localZ) const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _entries[entryIndex(localX, localZ)].length != 0;
+}
+
+bool RegionFile::read(int localX, int localZ, std::vector<std::uint8_t> &out) const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    const Entry &entry = _entries[entryIndex(localX, localZ)];
+    if (entry.length < 4) {
+        return false;
+    }
+
+    // the mapping can only be replaced by a write, which can't happen while we hold the lock
+    const std::uint8_t *payload = _file.data() + entry.firstSector * SECTOR_SIZE;
+    std::uint32_t uncompressedLength = readUint32(payload);
+    out.resize(uncompressedLength);
+    uLongf outLength = uncompressedLength;
+    int result = uncompress(out.data(), &outLength, payload + 4, entry.length - 4);
+    if (result != Z_OK || outLength != uncompressedLength) {
+        throw std::runtime_error("Could not read column (" + std::to_string(localX) + ", " + std::to_string(localZ)
+            + ") from '" + _file.path() + "': corrupt data");
+    }
+    return true;
+}
+
+void RegionFile::write(int localX, int localZ, const std::uint8_t *data, std::size_t length) {
+    // compress before taking the lock so other threads can keep reading
+    std::vector<std::uint8_t> payload(4 + compressBound(static_cast<uLong>(length)));
+    writeUint32(payload.data(), static_cast<std::uint32_t>(length));
+    uLongf compressedLength = static_cast<uLongf>(payload.size() - 4);
+    if (compress2(payload.data() + 4, &compressedLength, data, static_cast<uLong>(length), Z_BEST_SPEED) != Z_OK) {
+        throw std::runtime_error("Could not compress column for '" + _file.path() + "'");
+    }
+    std::size_t payloadLength = 4 + compressedLength;
+    std::size_t sectors = sectorsFor(payloadLength);
+    // whole sectors are written so the file always ends on a sector boundary
+    payload.resize(sectors * SECTOR_SIZE, 0);
+
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    int index = entryIndex(localX, localZ);
+    std::uint32_t firstSector = allocate(_entries[index], sectors);
+    _file.write(firstSector * SECTOR_SIZE, payload.data(), payload.size());
+    _entries[index] = {firstSector, static_cast<std::uint32_t>(payloadLength)};
+    writeEntry(index);
+}
+
+std::size_t RegionFile::sectorCount() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _usedSectors.size();
+}
+
+std::size_t RegionFile::freeSectorCount() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return static_cast<std::size_t>(std::count(_usedSectors.begin(), _usedSectors.end(), false));
+}
+
+int RegionFile::entryIndex(int localX, int localZ) {
+    return localZ * SIZE + localX;
+}
+
+std::size_t RegionFile::sectorsFor(std::size_t length) {
+    return (length + SECTOR_SIZE - 1) / SECTOR_SIZE;
+}
+
+std::uint32_t RegionFile::allocate(const Entry &previous, std::size_t sectors) {
+    // free the old sectors first, so a column that still fits ends up right where it was
+    if (previous.length != 0) {
+        auto first = _usedSectors.begin() + previous.firstSector;
+        std::fill(first, first + sectorsFor(previous.length), false);
+    }
+
+    // first fit. a free run at the very end of the file can be extended past it.
+    std::size_t runStart = 0;
+    std::size_t runLength = 0;
+    for (std::size_t i = HEADER_SECTORS; i < _usedSectors.size() && runLength < sectors; i++) {
+        if (_usedSectors[i]) {
+            runLength = 0;
+        } else {
+            if (runLength == 0) {
+                runStart = i;
+            }
+            runLength++;
+        }
+    }
+    if (runLength == 0) {
+        runStart = _usedSectors.size();
+    }
+
+    if (runStart + sectors > _usedSectors.size()) {
+        _usedSectors.resize(runStart + sectors, false);
+    }
+    std::fill(_usedSectors.begin() + runStart, _usedSectors.begin() + runStart + sectors, true);
+    return static_cast<std::uint32_t>(runStart);
+}
+
+void RegionFile::writeEntry(int index) {
+    std::uint8_t bytes[sizeof(Entry)];
+    writeUint32(bytes, _entries[index].firstSector);
+    writeUint32(bytes + 4, _entries[index].length);
+    _file.write(index * sizeof(Entry), bytes, sizeof(bytes));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Stores a 32x32 area of chunk columns in one file. The file starts with a fixed table of (first sector,
+// byte length) pairs, one per column, followed by zlib compressed payloads aligned to 4 KiB sectors.
+// Reading goes straight through a memory mapping. Rewriting a column reuses its sectors when it still
+// fits, otherwise it goes into the first free run of sectors or is appended, so the rest of the file
+// is never touched.
+//
+// Safe to use from several threads: reads run in parallel, writes are exclusive.
+class RegionFile {
+public:
+    static constexpr int SIZE = 32;
+    static constexpr int COLUMNS = SIZE * SIZE;
+    static constexpr std::size_t SECTOR_SIZE = 4096;
+
+private:
+    struct Entry {
+        std::uint32_t firstSector;
+        // compressed payload plus its 4 byte header, 0 if the column was never saved
+        std::uint32_t length;
+    };
+
+    static constexpr std::size_t HEADER_SIZE = COLUMNS * sizeof(Entry);
+    static constexpr std::size_t HEADER_SECTORS = (HEADER_SIZE + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+    MappedFile _file;
+    std::array<Entry, COLUMNS> _entries{};
+    std::vector<bool> _usedSectors{};
+    mutable std::shared_mutex _mutex{};
+
+public:
+    explicit RegionFile(const std::string &path);
+
+    bool contains(int localX, int localZ) const;
+    // decompresses the column's data into out. returns false if the column was never saved.
+    bool read(int localX, int localZ, std::vector<std::uint8_t> &out) const;
+    void write(int localX, int localZ, const std::uint8_t *data, std::size_t length);
+
+    std::size_t sectorCount() const;
+    std::size_t freeSectorCount() const;
+
+private:
+    static int entryIndex(int localX, int localZ);
+    static std::size_t sectorsFor(std::size_t length);
+
+    std::uint32_t allocate(const Entry &previous, std::size_t sectors);
+    void writeEntry(int index);
+};
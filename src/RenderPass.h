@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Geometry is drawn in these passes, in this order.
+enum class RenderPass : std::uint8_t {
+    // depth tested and written, nothing shows through
+    OPAQUE,
+    // like OPAQUE, but the fragment shader throws away see-through texels (leaves, torches)
+    CUTOUT,
+    // blended over everything else back to front, without writing depth (water)
+    TRANSLUCENT
+};
+
+constexpr std::size_t RENDER_PASS_COUNT = 3;
+
+// for stats and traces
+constexpr const char *RENDER_PASS_NAMES[RENDER_PASS_COUNT] = {"opaque", "cutout", "translucent"};
@@ -0,0 +1,150 @@
+#include "RenderQueue.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include <glad/glad.h>
+
+#include "GLState.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
+
+namespace {
+    // pass in the top 2 bits, and below that
+    //     opaque and cutout: program 10, texture 16, depth 24
+    //     translucent:       inverted depth 24, program 10, texture 16
+    // the lowest 12 bits are left empty
+    constexpr int PASS_SHIFT = 62;
+    constexpr int DEPTH_BITS = 24;
+    constexpr std::uint64_t DEPTH_MASK = (1ull << DEPTH_BITS) - 1;
+
+    // the bits of a float that isn't negative sort the same way the float does, so the top ones are a
+    // depth that keeps its precision close to the camera
+    std::uint64_t depthBits(float depth) {
+        depth = depth > 0.0f ? depth : 0.0f;
+        std::uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return bits >> (32 - DEPTH_BITS);
+    }
+}
+
+RenderQueue::RenderQueue(unsigned int workerCount) : _buckets(workerCount + 1) {
+}
+
+std::uint64_t RenderQueue::key(RenderPass pass, std::uint32_t program, std::uint32_t texture, float depth) {
+    if (program > MAX_PROGRAM || texture > MAX_TEXTURE) {
+        throw std::runtime_error("Could not make render key: program or texture id too big");
+    }
+    std::uint64_t key = static_cast<std::uint64_t>(pass) << PASS_SHIFT;
+    if (pass == RenderPass::TRANSLUCENT) {
+        return key | (~depthBits(depth) & DEPTH_MASK) << 38 | static_cast<std::uint64_t>(program) << 28
+            | static_cast<std::uint64_t>(texture) << 12;
+    }
+    return key | static_cast<std::uint64_t>(program) << 52 | static_cast<std::uint64_t>(texture) << 36
+        | depthBits(depth) << 12;
+}
+
+RenderPass RenderQueue::pass(std::uint64_t key) {
+    return static_cast<RenderPass>(key >> PASS_SHIFT);
+}
+
+void RenderQueue::submit(std::uint64_t key, Drawer &drawer, std::uint32_t item) {
+    auto bucket = static_cast<std::size_t>(JobSystem::currentWorker() + 1);
+    if (bucket >= _buckets.size()) {
+        throw std::runtime_error("Could not submit draw: the render queue has no bucket for this worker");
+    }
+    _buckets[bucket].packets.push_back({key, &drawer, item});
+}
+
+void RenderQueue::sort() {
+    _packets.clear();
+    for (auto &bucket : _buckets) {
+        _packets.insert(_packets.end(), bucket.packets.begin(), bucket.packets.end());
+        bucket.packets.clear();
+    }
+    _stats = {};
+    _stats.packets = _packets.size();
+
+    // least significant byte first. one read counts every byte position at once, and positions where all
+    // keys have the same byte are skipped, which is most of them since the low bits are mostly empty.
+    std::array<std::array<std::size_t, 256>, 8> counts{};
+    for (const auto &packet : _packets) {
+        for (int byte = 0; byte < 8; byte++) {
+            counts[byte][packet.key >> (byte * 8) & 0xFF]++;
+        }
+    }
+    _scratch.resize(_packets.size());
+    for (int byte = 0; byte < 8; byte++) {
+        auto &byteCounts = counts[byte];
+        if (_packets.empty() || byteCounts[_packets.front().key >> (byte * 8) & 0xFF] == _packets.size()) {
+            continue;
+        }
+        std::size_t offset = 0;
+        for (auto &count : byteCounts) {
+            std::size_t next = offset + count;
+            count = offset;
+            offset = next;
+        }
+        for (const auto &packet : _packets) {
+            _scratch[byteCounts[packet.key >> (byte * 8) & 0xFF]++] = packet;
+        }
+        _packets.swap(_scratch);
+        _stats.sortPasses++;
+    }
+}
+
+void RenderQueue::execute(GpuTimer *timer) {
+    std::size_t begin = 0;
+    bool passApplied[RENDER_PASS_COUNT] = {};
+    bool timing = false;
+    while (begin < _packets.size()) {
+        RenderPass pass = RenderQueue::pass(_packets[begin].key);
+        if (!passApplied[static_cast<std::size_t>(pass)]) {
+            applyPass(pass);
+            passApplied[static_cast<std::size_t>(pass)] = true;
+            // packets are sorted by pass first, so a pass never comes back
+            if (timer != nullptr) {
+                if (timing) {
+                    timer->end();
+                }
+                timer->begin(RENDER_PASS_NAMES[static_cast<std::size_t>(pass)]);
+                timing = true;
+            }
+        }
+        // a run ends where the drawer or the pass changes
+        std::size_t end = begin + 1;
+        while (end < _packets.size() && _packets[end].drawer == _packets[begin].drawer
+            && RenderQueue::pass(_packets[end].key) == pass) {
+            end++;
+        }
+        _packets[begin].drawer->draw(_packets.data() + begin, _packets.data() + end);
+        _stats.runs++;
+        begin = end;
+    }
+    if (timing) {
+        timer->end();
+    }
+    applyPass(RenderPass::OPAQUE);
+}
+
+void RenderQueue::clear() {
+    _packets.clear();
+    for (auto &bucket : _buckets) {
+        bucket.packets.clear();
+    }
+}
+
+const RenderQueue::Stats &RenderQueue::stats() const {
+    return _stats;
+}
+
+void RenderQueue::applyPass(RenderPass pass) {
+    bool translucent = pass == RenderPass::TRANSLUCENT;
+    GLState::setEnabled(GL_BLEND, translucent);
+    if (translucent) {
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    // glClear only clears depth while writing it is on, so it's always turned back on afterwards
+    GLState::depthMask(!translucent);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Memory.h"
+#include "RenderPass.h"
+
+class GpuTimer;
+
+// Collects the draws of a frame, sorts them by a 64 bit key and hands them back in order.
+//
+// Keys sort by pass first. Opaque and cutout draws then sort by program, texture and depth, so state only
+// changes when it has to and nearby things are drawn first, hiding whatever is behind them. Translucent
+// draws sort by depth right after the pass, farthest first, since they have to be blended in that order.
+//
+// Every thread submits into a bucket of its own, picked by JobSystem::currentWorker, so submitting takes no
+// locks. sort merges the buckets, which means submitting has to be finished by then.
+class RenderQueue {
+public:
+    // program and texture ids have to fit, they're usually small GL names or indices
+    static constexpr std::uint32_t MAX_PROGRAM = (1u << 10) - 1;
+    static constexpr std::uint32_t MAX_TEXTURE = (1u << 16) - 1;
+
+    class Drawer;
+
+    struct Packet {
+        std::uint64_t key;
+        Drawer *drawer;
+        // whatever the drawer needs to find the draw again
+        std::uint32_t item;
+    };
+
+    // something that submits packets and draws them once they're sorted
+    class Drawer {
+    public:
+        virtual ~Drawer() = default;
+        // packets are in key order, and all of them came from this drawer
+        virtual void draw(const Packet *begin, const Packet *end) = 0;
+    };
+
+    struct Stats {
+        std::size_t packets{0};
+        // runs of packets handed to a drawer at once
+        std::size_t runs{0};
+        // byte positions of the key radix sort actually had to sort by
+        std::size_t sortPasses{0};
+    };
+
+private:
+    using Packets = Memory::Vector<Packet, MemoryTag::RENDERING>;
+
+    // aligned so threads filling neighbouring buckets don't share cache lines
+    struct alignas(64) Bucket {
+        Packets packets{};
+    };
+
+    std::vector<Bucket> _buckets;
+    Packets _packets{};
+    Packets _scratch{};
+    Stats _stats{};
+
+public:
+    // one bucket for the main thread and one for each of workerCount job system workers
+    explicit RenderQueue(unsigned int workerCount);
+
+    // depth is the distance from the camera, anything not negative
+    static std::uint64_t key(RenderPass pass, std::uint32_t program, std::uint32_t texture, float depth);
+    static RenderPass pass(std::uint64_t key);
+
+    // can be called from any worker and the main thread at the same time
+    void submit(std::uint64_t key, Drawer &drawer, std::uint32_t item);
+    void sort();
+    // hands every run of packets from the same drawer to it, setting up each pass's blending and depth writes
+    // on the way. leaves the opaque pass's state behind. with a timer, every pass gets a zone of its own.
+    void execute(GpuTimer *timer = nullptr);
+    // forgets this frame's packets, keeping the memory
+    void clear();
+
+    // of the last sort and execute
+    const Stats &stats() const;
+
+private:
+    static void applyPass(RenderPass pass);
+};
@@ -1,18 +1,55 @@
 #include "ResourceManager.h"
+#include <algorithm>
+#include <cstddef>
 #include <stdexcept>
 #include <filesystem>
 
+#include <glad/glad.h>
+
+#include "GLState.h"
+#include "JobSystem.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 namespace fs = std::filesystem;
 
+namespace {
+    // nearest neighbour, so pixel art stays sharp when it's scaled up. also flips the image, stb_image
+    // starts at the top row and OpenGL at the bottom one.
+    void resample(const std::uint8_t *image, int width, int height, std::uint8_t *layer, unsigned int size) {
+        for (unsigned int y = 0; y < size; y++) {
+            auto sourceY = static_cast<std::size_t>(height - 1 - static_cast<int>(y * height / size));
+            for (unsigned int x = 0; x < size; x++) {
+                auto sourceX = static_cast<std::size_t>(x * width / size);
+                std::copy_n(image + (sourceY * width + sourceX) * 4, 4, layer + (y * size + x) * 4);
+            }
+        }
+    }
+
+    // magenta and black squares, shown until the real image is uploaded
+    void placeholder(std::uint8_t *layer, unsigned int size) {
+        unsigned int square = std::max(size / 2, 1u);
+        for (unsigned int y = 0; y < size; y++) {
+            for (unsigned int x = 0; x < size; x++) {
+                bool magenta = (x / square + y / square) % 2 == 0;
+                std::uint8_t *pixel = layer + (static_cast<std::size_t>(y) * size + x) * 4;
+                pixel[0] = magenta ? 255 : 0;
+                pixel[1] = 0;
+                pixel[2] = magenta ? 255 : 0;
+                pixel[3] = 255;
+            }
+        }
+    }
+}
+
 namespace Shaders {
     extern const char *vertex;
     extern const char *fragment;
 }
 
-ResourceManager::ResourceManager(const std::string &resourceRoot) : _resourceRoot(resourceRoot) {
+ResourceManager::ResourceManager(const std::string &resourceRoot, const std::string &programCacheDirectory)
+    : _resourceRoot(resourceRoot), _programCache(programCacheDirectory) {
 }
 
 const Shader &ResourceManager::loadShader(const std::string &name,
@@ -23,7 +60,7 @@ const Shader &ResourceManager::loadShader(const std::string &name,
     if (fragmentShader != "fragment") {
         throw std::runtime_error("Unknown fragment shader '" + fragmentShader + "'");
     }
-    Shader shader(Shaders::vertex, Shaders::fragment);
+    Shader shader(Shaders::vertex, Shaders::fragment, &_programCache);
 
     auto [pair, wasInserted] = _shaders.emplace(name, std::move(shader));
     if (!wasInserted) {
@@ -56,3 +93,120 @@ const Texture &ResourceManager::getTexture(const std::string &name) {
     return _textures.find(name)->second;
 }
 
+
+const TextureArray &ResourceManager::loadTextureArray(const std::string &name, const std::string &relativeDirectory,
+    const std::vector<std::string> &layerNames, JobSystem &jobs) {
+    if (_textureArrays.find(name) != _textureArrays.end()) {
+        throw std::runtime_error("Could not load texture array '" + name + "': A texture array with this name already exists.");
+    }
+
+    std::vector<std::string> filePaths;
+    unsigned int size = 1;
+    for (const auto &layerName : layerNames) {
+        filePaths.push_back(fs::path(_resourceRoot).append(relativeDirectory).append(layerName + ".png").string());
+        int width, height, channels;
+        if (!stbi_info(filePaths.back().c_str(), &width, &height, &channels)) {
+            throw std::runtime_error("Could not load texture '" + filePaths.back() + "': " + stbi_failure_reason());
+        }
+        size = std::max({size, static_cast<unsigned int>(width), static_cast<unsigned int>(height)});
+    }
+
+    std::size_t layerBytes = static_cast<std::size_t>(size) * size * 4;
+    std::vector<std::uint8_t> placeholders(layerBytes * filePaths.size());
+    for (std::size_t layer = 0; layer < filePaths.size(); layer++) {
+        placeholder(placeholders.data() + layer * layerBytes, size);
+    }
+    auto [pair, wasInserted] = _textureArrays.emplace(name,
+        TextureArray(placeholders.data(), size, static_cast<unsigned int>(filePaths.size())));
+    TextureArray *textureArray = &pair->second;
+
+    if (_pendingLayers == 0) {
+        _loadStart = std::chrono::steady_clock::now();
+    }
+    _pendingLayers += filePaths.size();
+    _pendingArrayLayers[textureArray] = filePaths.size();
+    for (std::size_t layer = 0; layer < filePaths.size(); layer++) {
+        jobs.schedule([this, textureArray, layer, size, filePath = filePaths[layer]]() {
+            auto start = std::chrono::steady_clock::now();
+            DecodedLayer decoded{textureArray, static_cast<unsigned int>(layer), {}, {}, 0.0};
+            int width, height, channels;
+            std::uint8_t *image = stbi_load(filePath.c_str(), &width, &height, &channels, 4);
+            if (image) {
+                decoded.pixels.resize(static_cast<std::size_t>(size) * size * 4);
+                resample(image, width, height, decoded.pixels.data(), size);
+                stbi_image_free(image);
+            } else {
+                decoded.error = "Could not load texture '" + filePath + "': " + stbi_failure_reason();
+            }
+            decoded.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(_decodedMutex);
+            _decoded.push_back(std::move(decoded));
+        });
+    }
+    return *textureArray;
+}
+
+const TextureArray &ResourceManager::getTextureArray(const std::string &name) {
+    return _textureArrays.find(name)->second;
+}
+
+bool ResourceManager::uploadTextures(std::size_t budgetBytes) {
+    if (_pendingLayers == 0) {
+        return true;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // takes layers from the back, so the ones left over stay where they are
+    std::vector<DecodedLayer> layers;
+    std::size_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(_decodedMutex);
+        while (!_decoded.empty() && (layers.empty() || bytes + _decoded.back().pixels.size() <= budgetBytes)) {
+            bytes += _decoded.back().pixels.size();
+            layers.push_back(std::move(_decoded.back()));
+            _decoded.pop_back();
+        }
+    }
+    if (layers.empty()) {
+        return false;
+    }
+
+    for (const auto &decoded : layers) {
+        if (!decoded.error.empty()) {
+            throw std::runtime_error(decoded.error);
+        }
+        std::size_t offset;
+        if (_textureStream.write(decoded.pixels.data(), decoded.pixels.size(), offset)) {
+            GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, _textureStream.buffer());
+            decoded.textureArray->setLayer(decoded.layer, reinterpret_cast<const void *>(offset));
+        } else {
+            GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            decoded.textureArray->setLayer(decoded.layer, decoded.pixels.data());
+            _textureLoadStats.directUploads++;
+        }
+        _textureLoadStats.decodeSeconds += decoded.seconds;
+        // once for the whole array rather than after every slice of it
+        auto pending = _pendingArrayLayers.find(decoded.textureArray);
+        if (--pending->second == 0) {
+            decoded.textureArray->generateMipmaps();
+            _pendingArrayLayers.erase(pending);
+        }
+    }
+    _textureStream.endFrame();
+
+    _pendingLayers -= layers.size();
+    auto now = std::chrono::steady_clock::now();
+    _textureLoadStats.layers += layers.size();
+    _textureLoadStats.bytes += bytes;
+    _textureLoadStats.uploadSeconds += std::chrono::duration<double>(now - start).count();
+    _textureLoadStats.uploadCalls++;
+    if (_pendingLayers == 0) {
+        _textureLoadStats.seconds = std::chrono::duration<double>(now - _loadStart).count();
+    }
+    return _pendingLayers == 0;
+}
+
+const ResourceManager::TextureLoadStats &ResourceManager::textureLoadStats() const {
+    return _textureLoadStats;
+}
@@ -1,23 +1,92 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "Memory.h"
+#include "ProgramCache.h"
 #include "Shader.h"
+#include "StreamBuffer.h"
 #include "Texture.h"
+#include "TextureArray.h"
+
+class JobSystem;
 
 class ResourceManager {
+public:
+    // decoded layers are copied through this on their way to the GPU
+    static constexpr std::size_t TEXTURE_STREAM_BUFFER_SIZE = 8 * 1024 * 1024;
+
+    struct TextureLoadStats {
+        std::size_t layers{0};
+        std::size_t bytes{0};
+        // cpu time spent reading, decoding and scaling images, summed over every worker
+        double decodeSeconds{0.0};
+        // main thread time spent in uploadTextures, mipmaps included
+        double uploadSeconds{0.0};
+        // calls that uploaded at least one layer
+        std::size_t uploadCalls{0};
+        // layers that couldn't go through the stream buffer and were handed to the driver directly
+        std::size_t directUploads{0};
+        // from the first loadTextureArray call until the last layer was uploaded
+        double seconds{0.0};
+    };
+
 private:
+    // a layer that's ready to upload
+    struct DecodedLayer {
+        TextureArray *textureArray;
+        unsigned int layer;
+        Memory::Vector<std::uint8_t, MemoryTag::TEXTURES> pixels;
+        // set instead of pixels if the image couldn't be loaded
+        std::string error;
+        // how long the worker took
+        double seconds;
+    };
+
     std::unordered_map<std::string, Shader> _shaders{};
     std::unordered_map<std::string, Texture> _textures{};
+    std::unordered_map<std::string, TextureArray> _textureArrays{};
     std::string _resourceRoot;
+    ProgramCache _programCache;
+
+    StreamBuffer _textureStream{TEXTURE_STREAM_BUFFER_SIZE, MemoryTag::TEXTURES};
+    std::mutex _decodedMutex{};
+    std::vector<DecodedLayer> _decoded{};
+    // layers of each array that haven't been uploaded yet. its mipmaps are generated once this gets to 0.
+    std::unordered_map<TextureArray *, std::size_t> _pendingArrayLayers{};
+    // layers that were scheduled but haven't been uploaded yet, only touched on the main thread
+    std::size_t _pendingLayers{0};
+    std::chrono::steady_clock::time_point _loadStart{};
+    TextureLoadStats _textureLoadStats{};
 
 public:
-    ResourceManager(const std::string &resourceRoot);
+    // linked shader programs are cached in programCacheDirectory
+    ResourceManager(const std::string &resourceRoot, const std::string &programCacheDirectory);
 
     const Shader &loadShader(const std::string &name, const std::string &vertexShader, const std::string &fragmentShader);
     const Shader &getShader(const std::string &name);
 
     const Texture &loadTexture(const std::string &name, const std::string &relativeFilePath, bool hasAlpha);
     const Texture &getTexture(const std::string &name);
+
+    // packs <relativeDirectory>/<layer name>.png for every layer name into one texture array, in the same
+    // order. the images are converted to RGBA and scaled to the size of the biggest one.
+    //
+    // only the image headers are read here. every layer starts out as a placeholder and the images are
+    // decoded on the job system, uploadTextures puts them into the array once they're done.
+    const TextureArray &loadTextureArray(const std::string &name, const std::string &relativeDirectory,
+        const std::vector<std::string> &layerNames, JobSystem &jobs);
+    const TextureArray &getTextureArray(const std::string &name);
+
+    // uploads decoded layers until about budgetBytes were uploaded, always at least one. call once a frame.
+    // returns true once every layer is in place. an array's mipmaps are only generated once all of its
+    // layers are, until then the smaller levels still show the placeholders.
+    bool uploadTextures(std::size_t budgetBytes);
+    const TextureLoadStats &textureLoadStats() const;
 };
\ No newline at end of file
@@ -1,30 +1,79 @@
 #include "Shader.h"
 #include <stdexcept>
+#include <string>
+#include <utility>
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+
 using namespace std::string_literals;
 
-Shader::Shader(const char *vertexShader, const char *fragmentShader) {
-    _vertexShaderId = createShader(&vertexShader, ShaderType::VERTEX);
-    _fragmentShaderId = createShader(&fragmentShader, ShaderType::FRAGMENT);
-    linkProgram();
+namespace {
+    // ARB_get_program_binary, which glad wasn't generated with
+    constexpr GLenum PROGRAM_BINARY_LENGTH = 0x8741;
+
+    // 0 without ARB_get_program_binary
+    std::size_t programBytes(unsigned int program) {
+        if (!GLExtensions::isSupported("GL_ARB_get_program_binary")) {
+            return 0;
+        }
+        GLint length = 0;
+        glGetProgramiv(program, PROGRAM_BINARY_LENGTH, &length);
+        return static_cast<std::size_t>(length);
+    }
+}
+
+Shader::Shader(const char *vertexShader, const char *fragmentShader, const ProgramCache *cache) {
+    std::uint64_t key = cache ? cache->key(vertexShader, fragmentShader) : 0;
+    if (!cache || !loadProgram(*cache, key)) {
+        _vertexShaderId = createShader(&vertexShader, ShaderType::VERTEX);
+        _fragmentShaderId = createShader(&fragmentShader, ShaderType::FRAGMENT);
+        linkProgram(cache);
+        if (cache) {
+            cache->save(_programId, key);
+        }
+    }
+    findUniformLocations();
+    bindUniformBlocks();
+    _gpuMemory = Memory::Allocation(MemoryDomain::GPU, MemoryTag::SHADERS, programBytes(_programId));
 }
 
 Shader::~Shader() {
     // checking for _programId == 0 (etc) is useless as glDeleteProgram/Shader does it already
     glDeleteShader(_vertexShaderId);
     glDeleteShader(_fragmentShaderId);
-    glDeleteProgram(_programId);
+    GLState::deleteProgram(_programId);
+}
+
+Shader::Shader(Shader &&other) noexcept
+    : _vertexShaderId(std::exchange(other._vertexShaderId, 0)),
+      _fragmentShaderId(std::exchange(other._fragmentShaderId, 0)),
+      _programId(std::exchange(other._programId, 0)),
+      _uniformLocations(other._uniformLocations),
+      _gpuMemory(std::move(other._gpuMemory)) {
 }
 
-void Shader::linkProgram() {
+Shader &Shader::operator=(Shader &&other) noexcept {
+    std::swap(_vertexShaderId, other._vertexShaderId);
+    std::swap(_fragmentShaderId, other._fragmentShaderId);
+    std::swap(_programId, other._programId);
+    std::swap(_uniformLocations, other._uniformLocations);
+    std::swap(_gpuMemory, other._gpuMemory);
+    return *this;
+}
+
+void Shader::linkProgram(const ProgramCache *cache) {
     _programId = glCreateProgram();
     if (_programId == 0) {
         throw std::runtime_error("Could not create shader program.");
     }
+    if (cache) {
+        cache->prepare(_programId);
+    }
 
     glAttachShader(_programId, _vertexShaderId);
     glAttachShader(_programId, _fragmentShaderId);
@@ -38,6 +87,8 @@ void Shader::linkProgram() {
         throw std::runtime_error("Could not link shader program:\n    "s + infoLog);
     }
 
+    // every sampler starts out on unit 0, which doesn't validate when samplers of different types share it
+    assignSamplerUnits();
     glValidateProgram(_programId);
     glGetProgramiv(_programId, GL_VALIDATE_STATUS, &success);
     if (!success) {
@@ -46,6 +97,48 @@ void Shader::linkProgram() {
     }
 }
 
+bool Shader::loadProgram(const ProgramCache &cache, std::uint64_t key) {
+    _programId = glCreateProgram();
+    if (_programId == 0) {
+        throw std::runtime_error("Could not create shader program.");
+    }
+    // a cached binary was validated when it was first linked, so that isn't done again
+    if (cache.load(_programId, key)) {
+        // uniform values aren't part of the binary, so the samplers are back on unit 0
+        assignSamplerUnits();
+        return true;
+    }
+    GLState::deleteProgram(_programId);
+    _programId = 0;
+    return false;
+}
+
+void Shader::findUniformLocations() {
+    for (std::size_t i = 0; i < _uniformLocations.size(); i++) {
+        _uniformLocations[i] = glGetUniformLocation(_programId, Shaders::uniformNames[i]);
+    }
+}
+
+void Shader::assignSamplerUnits() {
+    use();
+    for (std::size_t i = 0; i < static_cast<std::size_t>(Uniform::COUNT); i++) {
+        int location = glGetUniformLocation(_programId, Shaders::uniformNames[i]);
+        int unit = Shaders::uniformTextureUnits[i];
+        if (unit != -1 && location != -1) {
+            glUniform1i(location, unit);
+        }
+    }
+}
+
+void Shader::bindUniformBlocks() {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(UniformBlock::COUNT); i++) {
+        unsigned int index = glGetUniformBlockIndex(_programId, Shaders::uniformBlockNames[i]);
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(_programId, index, static_cast<unsigned int>(i));
+        }
+    }
+}
+
 unsigned int Shader::createShader(const char *const *source, ShaderType type) {
     auto openglShaderType = (type == ShaderType::VERTEX) ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER;
     unsigned int shaderId = glCreateShader(openglShaderType);
@@ -65,30 +158,39 @@ unsigned int Shader::createShader(const char *const *source, ShaderType type) {
 }
 
 void Shader::use() const {
-    glUseProgram(_programId);
+    GLState::useProgram(_programId);
 }
 
-void Shader::set(const std::string &name, bool value) const {
-    glUniform1i(getUniformLocation(name), static_cast<int>(value));
+unsigned int Shader::id() const {
+    return _programId;
 }
 
-void Shader::set(const std::string &name, int value) const {
-    glUniform1i(getUniformLocation(name), value);
+void Shader::set(Uniform uniform, bool value) const {
+    glUniform1i(getUniformLocation(uniform), static_cast<int>(value));
 }
 
-void Shader::set(const std::string &name, float value) const {
-    glUniform1f(getUniformLocation(name), value);
+void Shader::set(Uniform uniform, int value) const {
+    glUniform1i(getUniformLocation(uniform), value);
 }
 
-void Shader::set(const std::string &name, const glm::mat4 &value) const {
-    auto location = getUniformLocation(name);
+void Shader::set(Uniform uniform, float value) const {
+    glUniform1f(getUniformLocation(uniform), value);
+}
+
+void Shader::set(Uniform uniform, const glm::mat4 &value) const {
+    auto location = getUniformLocation(uniform);
     glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
-int Shader::getUniformLocation(const std::string &name) const {
-    auto location = glGetUniformLocation(_programId, name.c_str());
+bool Shader::has(Uniform uniform) const {
+    return _uniformLocations[static_cast<std::size_t>(uniform)] >= 0;
+}
+
+int Shader::getUniformLocation(Uniform uniform) const {
+    auto location = _uniformLocations[static_cast<std::size_t>(uniform)];
     if (location < 0) {
-        throw std::runtime_error("Could not find uniform '" + name + "'");
+        auto name = Shaders::uniformNames[static_cast<std::size_t>(uniform)];
+        throw std::runtime_error("Could not find uniform '"s + name + "'");
     }
     return location;
 }
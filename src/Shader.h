@@ -1,28 +1,44 @@
 #pragma once
 
-#include <string>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <glm/fwd.hpp>
 
+#include "Memory.h"
+#include "ShaderUniforms.h"
+
+class ProgramCache;
+
 class Shader {
 private:
     unsigned int _vertexShaderId{};
     unsigned int _fragmentShaderId{};
     unsigned int _programId{};
+    // looked up once after linking, -1 for uniforms this program doesn't have
+    std::array<int, static_cast<std::size_t>(Uniform::COUNT)> _uniformLocations{};
+    // the size of the program's binary, the closest thing to its size GL can tell
+    Memory::Allocation _gpuMemory{};
 
 public:
-    Shader(const char *vertexShader, const char *fragmentShader);
+    // with a cache, the linked program is loaded from it when it's there and saved to it when it isn't
+    Shader(const char *vertexShader, const char *fragmentShader, const ProgramCache *cache = nullptr);
     ~Shader();
     Shader(const Shader &other) = delete;
     Shader& operator=(const Shader &other) = delete;
-    Shader(Shader &&other) noexcept = default;
-    Shader& operator=(Shader &&other) noexcept = default;
+    Shader(Shader &&other) noexcept;
+    Shader& operator=(Shader &&other) noexcept;
 
     void use() const;
+    unsigned int id() const;
 
-    void set(const std::string &name, bool value) const;
-    void set(const std::string &name, int value) const;
-    void set(const std::string &name, float value) const;
-    void set(const std::string &name, const glm::mat4 &value) const;
+    // throws if the program doesn't have the uniform
+    void set(Uniform uniform, bool value) const;
+    void set(Uniform uniform, int value) const;
+    void set(Uniform uniform, float value) const;
+    void set(Uniform uniform, const glm::mat4 &value) const;
+
+    bool has(Uniform uniform) const;
 
 private:
     enum class ShaderType {
@@ -32,9 +48,17 @@ private:
 
     static unsigned int createShader(const char *const *source, ShaderType type);
 
-    void linkProgram();
+    void linkProgram(const ProgramCache *cache);
+    bool loadProgram(const ProgramCache &cache, std::uint64_t key);
+
+    void findUniformLocations();
+    // sets every sampler to its unit from Shaders::textureUnit, users bind their textures there
+    // instead of setting samplers
+    void assignSamplerUnits();
+    // points every uniform block the program has at its binding point, see UniformBlock
+    void bindUniformBlocks();
 
-    int getUniformLocation(const std::string &name) const;
+    int getUniformLocation(Uniform uniform) const;
 };
 
 
@@ -0,0 +1,122 @@
+#include "StreamBuffer.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "GLExtensions.h"
+#include "GLState.h"
+
+namespace {
+    // glad is generated for plain 3.3, so the extension is loaded by hand
+    constexpr GLbitfield MAP_PERSISTENT_BIT = 0x0040;
+    constexpr GLbitfield MAP_COHERENT_BIT = 0x0080;
+    typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+    BufferStorageProc loadBufferStorage() {
+        if (!GLExtensions::isSupported("GL_ARB_buffer_storage")) {
+            return nullptr;
+        }
+        return reinterpret_cast<BufferStorageProc>(GLExtensions::procAddress("glBufferStorage"));
+    }
+}
+
+StreamBuffer::StreamBuffer(std::size_t size, MemoryTag tag)
+    : _size(size - size % REGION_COUNT), _regionSize(size / REGION_COUNT),
+      _gpuMemory(MemoryDomain::GPU, tag, _size) {
+    glGenBuffers(1, &_buffer);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+    BufferStorageProc bufferStorage = loadBufferStorage();
+    if (bufferStorage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | MAP_PERSISTENT_BIT | MAP_COHERENT_BIT;
+        bufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(_size), nullptr, flags);
+        _mapped = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0,
+            static_cast<GLsizeiptr>(_size), flags));
+        if (!_mapped) {
+            GLState::deleteBuffers(1, &_buffer);
+            throw std::runtime_error("Could not map stream buffer");
+        }
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(_size), nullptr, GL_STREAM_DRAW);
+    }
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (GLsync fence : _fences) {
+        if (fence) {
+            glDeleteSync(fence);
+        }
+    }
+    if (_mapped) {
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    GLState::deleteBuffers(1, &_buffer);
+}
+
+bool StreamBuffer::write(const void *data, std::size_t size, std::size_t &offset) {
+    // keeps every write 4 byte aligned, which is all glCopyBufferSubData needs for vertex data
+    std::size_t alignedSize = (size + 3) & ~static_cast<std::size_t>(3);
+    if (alignedSize > _regionSize) {
+        return false;
+    }
+    if (_head + alignedSize > (_region + 1) * _regionSize && !nextRegion()) {
+        return false;
+    }
+
+    offset = _head;
+    if (_mapped) {
+        std::memcpy(_mapped + offset, data, size);
+    } else {
+        // the fences already make sure the GPU is done with this range, so the driver doesn't need to check
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+        void *mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+            static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!mapped) {
+            return false;
+        }
+        std::memcpy(mapped, data, size);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    _head += alignedSize;
+    return true;
+}
+
+void StreamBuffer::endFrame() {
+    if (_head == _fencedHead) {
+        return;
+    }
+    // a later fence covers everything an earlier one did, so only the newest is kept
+    if (_fences[_region]) {
+        glDeleteSync(_fences[_region]);
+    }
+    _fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _fencedHead = _head;
+}
+
+unsigned int StreamBuffer::buffer() const {
+    return _buffer;
+}
+
+bool StreamBuffer::isPersistent() const {
+    return _mapped != nullptr;
+}
+
+bool StreamBuffer::nextRegion() {
+    std::size_t next = (_region + 1) % REGION_COUNT;
+    GLsync fence = _fences[next];
+    if (fence) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return false;
+        }
+        glDeleteSync(fence);
+        _fences[next] = nullptr;
+    }
+
+    // the copies out of the region being left were already issued, so it can be fenced right away
+    endFrame();
+    _region = next;
+    _head = next * _regionSize;
+    _fencedHead = _head;
+    return true;
+}
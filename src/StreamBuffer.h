@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include "Memory.h"
+
+// A big buffer that data for the GPU is written into from the CPU, to be copied from with
+// glCopyBufferSubData. It is split into regions used one after the other, and each region is fenced once
+// the GPU has been told to read it, so the CPU only writes to a region again after the GPU is done with it.
+//
+// Where ARB_buffer_storage is there the buffer stays mapped the whole time. Plain GL 3.3 maps each write
+// with GL_MAP_UNSYNCHRONIZED_BIT instead, which the fences make safe. Needs a current OpenGL context.
+class StreamBuffer {
+public:
+    static constexpr std::size_t REGION_COUNT = 4;
+
+private:
+    unsigned int _buffer{0};
+    std::size_t _size;
+    std::size_t _regionSize;
+    // null unless the buffer is persistently mapped
+    unsigned char *_mapped{nullptr};
+
+    std::size_t _region{0};
+    std::size_t _head{0};
+    // where the current region was last fenced, so endFrame knows if there's anything new
+    std::size_t _fencedHead{0};
+    std::array<GLsync, REGION_COUNT> _fences{};
+    Memory::Allocation _gpuMemory;
+
+public:
+    // the buffer counts towards tag, for whatever it's staging
+    StreamBuffer(std::size_t size, MemoryTag tag);
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer &other) = delete;
+    StreamBuffer &operator=(const StreamBuffer &other) = delete;
+
+    // copies data into the buffer and sets offset to where it went. returns false instead of waiting if
+    // the GPU is still reading the next region, or if data is bigger than a region.
+    bool write(const void *data, std::size_t size, std::size_t &offset);
+    // fences everything written so far. call once a frame, after the commands reading it were issued.
+    void endFrame();
+
+    unsigned int buffer() const;
+    bool isPersistent() const;
+
+private:
+    // moves on to the next region if the GPU is done with it
+    bool nextRegion();
+};
@@ -0,0 +1,126 @@
+#include "TerrainGenerator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    constexpr int S = ChunkSection::SIZE;
+
+    int blockIndex(int x, int y, int z) {
+        // sections are stacked in y, so this is also ChunkSection::index() within each section
+        return (y * S + z) * S + x;
+    }
+
+    std::uint32_t hashPosition(int seed, int x, int z) {
+        auto hash = static_cast<std::uint32_t>(seed) ^ (static_cast<std::uint32_t>(x) * 0x9E3779B1u)
+            ^ (static_cast<std::uint32_t>(z) * 0x85EBCA77u);
+        hash ^= hash >> 15;
+        hash *= 0x2C1B3C6Du;
+        hash ^= hash >> 12;
+        return hash;
+    }
+}
+
+TerrainGenerator::TerrainGenerator(int seed) : _seed(seed) {
+    _heightNoise.seed = seed;
+    _heightNoise.octaves = 5;
+    _heightNoise.frequency = 1.0f / 256.0f;
+
+    _caveNoise.seed = seed + 1;
+    _caveNoise.octaves = 2;
+    _caveNoise.frequency = 1.0f / 32.0f;
+}
+
+TerrainGenerator::Column TerrainGenerator::generateColumn(int chunkX, int chunkZ) const {
+    const int originX = chunkX * S;
+    const int originZ = chunkZ * S;
+
+    float heightNoise[ChunkSection::AREA];
+    Noise::fbm2D(_heightNoise, originX, originZ, S, S, heightNoise);
+
+    int surface[ChunkSection::AREA];
+    int maxSurface = 0;
+    for (int i = 0; i < ChunkSection::AREA; i++) {
+        surface[i] = std::clamp(SEA_LEVEL + 8 + static_cast<int>(heightNoise[i] * 40.0f), 1, COLUMN_HEIGHT - 16);
+        maxSurface = std::max(maxSurface, surface[i]);
+    }
+
+    std::vector<BlockId> blocks(static_cast<std::size_t>(COLUMN_HEIGHT) * ChunkSection::AREA, Blocks::AIR);
+    for (int z = 0; z < S; z++) {
+        for (int x = 0; x < S; x++) {
+            int height = surface[z * S + x];
+            bool beach = height >= SEA_LEVEL - 3 && height <= SEA_LEVEL + 1;
+            for (int y = 0; y < std::max(height, SEA_LEVEL); y++) {
+                BlockId block;
+                if (y >= height) {
+                    block = Blocks::WATER;
+                } else if (y < height - 4) {
+                    block = Blocks::STONE;
+                } else if (beach) {
+                    block = Blocks::SAND;
+                } else if (y == height - 1) {
+                    block = height > SEA_LEVEL ? Blocks::GRASS : Blocks::DIRT;
+                } else {
+                    block = Blocks::DIRT;
+                }
+                blocks[blockIndex(x, y, z)] = block;
+            }
+        }
+    }
+
+    // carve caves, but keep a solid roof under water so the ocean doesn't drain into them
+    float caveNoise[ChunkSection::VOLUME];
+    for (int sectionY = 0; sectionY * S < maxSurface; sectionY++) {
+        Noise::fbm3D(_caveNoise, originX, sectionY * S, originZ, S, S, S, caveNoise);
+        for (int i = 0; i < ChunkSection::VOLUME; i++) {
+            int y = sectionY * S + (i >> 8);
+            int height = surface[i & 0xFF];
+            int roof = height < SEA_LEVEL + 2 ? height - 6 : height;
+            if (y > 0 && y < roof && caveNoise[i] > 0.45f) {
+                blocks[sectionY * ChunkSection::VOLUME + i] = Blocks::AIR;
+            }
+        }
+    }
+
+    // trees stay inside the column so generating never has to touch a neighbour
+    for (int z = 2; z < S - 2; z++) {
+        for (int x = 2; x < S - 2; x++) {
+            int height = surface[z * S + x];
+            if (blocks[blockIndex(x, height - 1, z)] != Blocks::GRASS
+                || hashPosition(_seed, originX + x, originZ + z) % 97 != 0) {
+                continue;
+            }
+            int trunkTop = height + 4;
+            for (int y = height; y < trunkTop; y++) {
+                blocks[blockIndex(x, y, z)] = Blocks::LOG;
+            }
+            for (int y = trunkTop - 2; y <= trunkTop; y++) {
+                int radius = y == trunkTop ? 1 : 2;
+                for (int dz = -radius; dz <= radius; dz++) {
+                    for (int dx = -radius; dx <= radius; dx++) {
+                        BlockId &block = blocks[blockIndex(x + dx, y, z + dz)];
+                        if (block == Blocks::AIR) {
+                            block = Blocks::LEAVES;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    Column column;
+    for (int sectionY = 0; sectionY < COLUMN_SECTIONS; sectionY++) {
+        const BlockId *sectionBlocks = blocks.data() + sectionY * ChunkSection::VOLUME;
+        bool empty = std::all_of(sectionBlocks, sectionBlocks + ChunkSection::VOLUME,
+            [](BlockId block) { return block == Blocks::AIR; });
+        if (!empty) {
+            column[sectionY] = std::make_unique<ChunkSection>(sectionBlocks);
+        }
+    }
+    return column;
+}
+
+int TerrainGenerator::seed() const {
+    return _seed;
+}
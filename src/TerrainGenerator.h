@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ChunkSection.h"
+#include "Noise.h"
+#include "World.h"
+
+// Generates terrain one column of sections at a time. Generating is const and keeps no state between
+// calls, so any number of jobs can share one generator.
+class TerrainGenerator {
+public:
+    static constexpr int COLUMN_SECTIONS = World::COLUMN_SECTIONS;
+    static constexpr int COLUMN_HEIGHT = COLUMN_SECTIONS * ChunkSection::SIZE;
+    static constexpr int SEA_LEVEL = 48;
+
+    // sections that are entirely air are left empty
+    using Column = World::Column;
+
+private:
+    int _seed;
+    Noise::FbmSettings _heightNoise{};
+    Noise::FbmSettings _caveNoise{};
+
+public:
+    explicit TerrainGenerator(int seed);
+
+    Column generateColumn(int chunkX, int chunkZ) const;
+
+    int seed() const;
+};
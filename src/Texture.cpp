@@ -1,33 +1,49 @@
 #include "Texture.h"
 
+#include <utility>
+
 #include <glad/glad.h>
 
-Texture::Texture(std::uint8_t *data, unsigned int width, unsigned int height, bool hasAlpha) : _width(width), _height(height) {
+#include "GLState.h"
+
+Texture::Texture(std::uint8_t *data, unsigned int width, unsigned int height, bool hasAlpha) : _width(width), _height(height),
+    _gpuMemory(MemoryDomain::GPU, MemoryTag::TEXTURES, Memory::textureBytes(width, height, 1, hasAlpha ? 4 : 3, true)) {
     glGenTextures(1, &_id);
-    glBindTexture(GL_TEXTURE_2D, _id);
+    GLState::bindTexture(0, GL_TEXTURE_2D, _id);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+    GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     if (hasAlpha) {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
     } else {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
     }
     glGenerateMipmap(GL_TEXTURE_2D);
-
-    // unbind this texture
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 Texture::~Texture() {
-    glDeleteTextures(1, &_id);
+    GLState::deleteTextures(1, &_id);
+}
+
+Texture::Texture(Texture &&other) noexcept
+    : _id(std::exchange(other._id, 0)), _width(other._width), _height(other._height),
+      _gpuMemory(std::move(other._gpuMemory)) {
+}
+
+Texture &Texture::operator=(Texture &&other) noexcept {
+    std::swap(_id, other._id);
+    std::swap(_width, other._width);
+    std::swap(_height, other._height);
+    std::swap(_gpuMemory, other._gpuMemory);
+    return *this;
 }
 
-void Texture::bind() const {
-    glBindTexture(GL_TEXTURE_2D, _id);
+void Texture::bind(unsigned int unit) const {
+    GLState::bindTexture(unit, GL_TEXTURE_2D, _id);
 }
 
 unsigned int Texture::width() const {
@@ -2,24 +2,27 @@
 
 #include <cstdint>
 
+#include "Memory.h"
+
 class Texture {
 private:
     unsigned int _id;
     unsigned int _width;
     unsigned int _height;
+    Memory::Allocation _gpuMemory;
 
 public:
     Texture(std::uint8_t *data, unsigned int width, unsigned int height, bool hasAlpha);
     ~Texture();
     Texture(const Texture &other) = delete;
     Texture &operator=(const Texture &other) = delete;
-    Texture(Texture &&other) noexcept = default;
-    Texture &operator=(Texture &&other) noexcept = default;
+    Texture(Texture &&other) noexcept;
+    Texture &operator=(Texture &&other) noexcept;
 
     unsigned int width() const;
     unsigned int height() const;
 
-    void bind() const;
+    void bind(unsigned int unit = 0) const;
 };
 
 
@@ -0,0 +1,66 @@
+#include "TextureArray.h"
+
+#include <utility>
+
+#include <glad/glad.h>
+
+#include "GLState.h"
+
+TextureArray::TextureArray(const std::uint8_t *pixels, unsigned int size, unsigned int layers)
+    : _size(size), _layers(layers),
+      _gpuMemory(MemoryDomain::GPU, MemoryTag::TEXTURES, Memory::textureBytes(size, size, layers, 4, true)) {
+    glGenTextures(1, &_id);
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, _id);
+
+    // quads from the greedy mesher span several blocks, so their textures have to repeat
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // keep the pixels sharp up close, but don't shimmer in the distance
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    // rows of RGBA pixels are always 4 byte aligned, which is what GL_UNPACK_ALIGNMENT expects by default
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, size, size, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    // mipmaps of an array texture never mix layers
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+TextureArray::~TextureArray() {
+    GLState::deleteTextures(1, &_id);
+}
+
+TextureArray::TextureArray(TextureArray &&other) noexcept
+    : _id(std::exchange(other._id, 0)), _size(other._size), _layers(other._layers),
+      _gpuMemory(std::move(other._gpuMemory)) {
+}
+
+TextureArray &TextureArray::operator=(TextureArray &&other) noexcept {
+    std::swap(_id, other._id);
+    std::swap(_size, other._size);
+    std::swap(_layers, other._layers);
+    std::swap(_gpuMemory, other._gpuMemory);
+    return *this;
+}
+
+unsigned int TextureArray::size() const {
+    return _size;
+}
+
+unsigned int TextureArray::layers() const {
+    return _layers;
+}
+
+void TextureArray::bind(unsigned int unit) const {
+    GLState::bindTexture(unit, GL_TEXTURE_2D_ARRAY, _id);
+}
+
+void TextureArray::setLayer(unsigned int layer, const void *pixels) {
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, _id);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, _size, _size, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+void TextureArray::generateMipmaps() {
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, _id);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
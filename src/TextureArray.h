@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Memory.h"
+
+// A GL_TEXTURE_2D_ARRAY of square RGBA layers that all have the same size, each with its own mipmaps.
+// Block textures live in one of these, so the whole world is drawn with a single texture bound and each
+// vertex picks its layer.
+class TextureArray {
+private:
+    unsigned int _id{0};
+    unsigned int _size;
+    unsigned int _layers;
+    Memory::Allocation _gpuMemory;
+
+public:
+    // pixels holds every layer one after the other, size * size * 4 bytes each
+    TextureArray(const std::uint8_t *pixels, unsigned int size, unsigned int layers);
+    ~TextureArray();
+    TextureArray(const TextureArray &other) = delete;
+    TextureArray &operator=(const TextureArray &other) = delete;
+    TextureArray(TextureArray &&other) noexcept;
+    TextureArray &operator=(TextureArray &&other) noexcept;
+
+    // width and height of every layer
+    unsigned int size() const;
+    unsigned int layers() const;
+
+    void bind(unsigned int unit = 0) const;
+
+    // replaces one layer's pixels, size * size * 4 bytes. with a GL_PIXEL_UNPACK_BUFFER bound, pixels is an
+    // offset into it instead. the mipmaps are left alone until generateMipmaps.
+    void setLayer(unsigned int layer, const void *pixels);
+    void generateMipmaps();
+};
@@ -2,8 +2,12 @@
 #include <stdexcept>
 #include <iostream>
 
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "Profiler.h"
+
 Window::Window(int width, int height, const char *title) :
-    _width(width), _height(height), _resized(false), _input(*this) {
+    _title(title), _width(width), _height(height), _resized(false), _input(*this) {
     glfwSetErrorCallback([](auto error, auto desc) {
         std::cerr << "GLFW Error #" << error << ": " << desc << std::endl;
     });
@@ -30,6 +34,7 @@ Window::Window(int width, int height, const char *title) :
 
     // Allows access of this from a GLFWwindow*
     glfwSetWindowUserPointer(_window, this);
+    _input.setupCallbacks(*this);
 
     // Set callbacks
     glfwSetFramebufferSizeCallback(_window, [](auto glfwWindow, int width, int height) {
@@ -45,17 +50,18 @@ Window::Window(int width, int height, const char *title) :
     // Setup OpenGL
     glfwMakeContextCurrent(_window);
     gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+    GLExtensions::init(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
     glfwSwapInterval(1); // enable vsync
     glClearColor(0.3, 0.3, 0.3, 1.0);
 
     // configure global opengl state
-    glEnable(GL_DEPTH_TEST);
+    GLState::setEnabled(GL_DEPTH_TEST, true);
     //transparency
-    //glEnable(GL_BLEND);
-    //glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    //GLState::setEnabled(GL_BLEND, true);
+    //GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     // Enable face culling (only render visible faces)
-    //glEnable(GL_CULL_FACE);
-    //glCullFace(GL_BACK);
+    //GLState::setEnabled(GL_CULL_FACE, true);
+    //GLState::cullFace(GL_BACK);
     // Enable polygon mode -- wireframe
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 }
@@ -65,10 +71,16 @@ Window::~Window() {
 }
 
 void Window::update() {
+    Profiler::Zone zone("Window::update");
+    _input.clearMouseOffset();
     glfwPollEvents();
     glfwSwapBuffers(_window);
 }
 
+void Window::setStatus(const std::string &status) {
+    glfwSetWindowTitle(_window, (_title + " - " + status).c_str());
+}
+
 Input &Window::input() {
     return _input;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
@@ -8,6 +10,7 @@
 class Window {
 private:
     GLFWwindow *_window;
+    std::string _title;
     int _width;
     int _height;
     bool _resized;
@@ -22,6 +25,8 @@ public:
     Window& operator=(Window&&) = default;
 
     void update();
+    // shown in the title bar after the title
+    void setStatus(const std::string &status);
 
     Input &input();
     const Input &input() const;
@@ -0,0 +1,178 @@
+#include "World.h"
+
+#include <iomanip>
+
+std::size_t WorldMemoryReport::bytesPerSection() const {
+    return sectionCount == 0 ? 0 : totalBytes / sectionCount;
+}
+
+std::ostream &operator<<(std::ostream &stream, const WorldMemoryReport &report) {
+    static const char *bitNames[6] = {"0", "1", "2", "4", "8", "16"};
+    stream << report.sectionCount << " sections, "
+        << std::fixed << std::setprecision(2) << report.totalBytes / (1024.0 * 1024.0) << " MiB total, "
+        << report.bytesPerSection() << " bytes/section\n";
+    for (int i = 0; i < 6; i++) {
+        stream << "    " << std::setw(2) << bitNames[i] << " bits/block: " << report.sectionsByBits[i] << " sections\n";
+    }
+    return stream;
+}
+
+BlockId World::getBlock(const glm::ivec3 &pos) const {
+    auto section = getSection(toSectionPos(pos));
+    if (!section) {
+        return Blocks::AIR;
+    }
+    auto local = toLocalPos(pos);
+    return section->get(local.x, local.y, local.z);
+}
+
+void World::setBlock(const glm::ivec3 &pos, BlockId block) {
+    if (pos.y < 0 || pos.y >= HEIGHT) {
+        return;
+    }
+    auto sectionPos = toSectionPos(pos);
+    auto section = getSection(sectionPos);
+    if (!section) {
+        if (block == Blocks::AIR) {
+            return;
+        }
+        section = &getOrCreateSection(sectionPos);
+    }
+    auto local = toLocalPos(pos);
+    if (section->get(local.x, local.y, local.z) == block) {
+        return;
+    }
+    section->set(local.x, local.y, local.z, block);
+    _modifiedColumns.insert({sectionPos.x, sectionPos.z});
+    _changedBlocks.push_back(pos);
+    markDirty(pos);
+}
+
+void World::markDirty(const glm::ivec3 &pos) {
+    auto sectionPos = toSectionPos(pos);
+    auto local = toLocalPos(pos);
+    // blocks on a border also decide which faces the neighbour across it shows
+    _dirtySections.insert(sectionPos);
+    for (int axis = 0; axis < 3; axis++) {
+        if (local[axis] == 0 || local[axis] == ChunkSection::SIZE - 1) {
+            glm::ivec3 neighbour = sectionPos;
+            neighbour[axis] += local[axis] == 0 ? -1 : 1;
+            _dirtySections.insert(neighbour);
+        }
+    }
+}
+
+ChunkSection *World::getSection(const glm::ivec3 &sectionPos) {
+    auto iterator = _sections.find(sectionPos);
+    return iterator != _sections.end() ? iterator->second.get() : nullptr;
+}
+
+const ChunkSection *World::getSection(const glm::ivec3 &sectionPos) const {
+    auto iterator = _sections.find(sectionPos);
+    return iterator != _sections.end() ? iterator->second.get() : nullptr;
+}
+
+ChunkSection &World::getOrCreateSection(const glm::ivec3 &sectionPos) {
+    auto &section = _sections[sectionPos];
+    if (!section) {
+        section = std::make_unique<ChunkSection>();
+    }
+    return *section;
+}
+
+void World::setSection(const glm::ivec3 &sectionPos, std::unique_ptr<ChunkSection> section) {
+    _sections[sectionPos] = std::move(section);
+}
+
+void World::removeSection(const glm::ivec3 &sectionPos) {
+    _sections.erase(sectionPos);
+}
+
+void World::setColumn(int chunkX, int chunkZ, Column column) {
+    for (int sectionY = 0; sectionY < COLUMN_SECTIONS; sectionY++) {
+        if (column[sectionY]) {
+            _sections[{chunkX, sectionY, chunkZ}] = std::move(column[sectionY]);
+        } else {
+            _sections.erase({chunkX, sectionY, chunkZ});
+        }
+    }
+}
+
+World::Column World::takeColumn(int chunkX, int chunkZ) {
+    Column column;
+    for (int sectionY = 0; sectionY < COLUMN_SECTIONS; sectionY++) {
+        auto iterator = _sections.find({chunkX, sectionY, chunkZ});
+        if (iterator != _sections.end()) {
+            column[sectionY] = std::move(iterator->second);
+            _sections.erase(iterator);
+        }
+    }
+    return column;
+}
+
+World::ColumnView World::getColumn(int chunkX, int chunkZ) const {
+    ColumnView column{};
+    for (int sectionY = 0; sectionY < COLUMN_SECTIONS; sectionY++) {
+        column[sectionY] = getSection({chunkX, sectionY, chunkZ});
+    }
+    return column;
+}
+
+bool World::isColumnModified(int chunkX, int chunkZ) const {
+    return _modifiedColumns.count({chunkX, chunkZ}) != 0;
+}
+
+void World::clearModified(int chunkX, int chunkZ) {
+    _modifiedColumns.erase({chunkX, chunkZ});
+}
+
+std::vector<glm::ivec2> World::modifiedColumns() const {
+    return {_modifiedColumns.begin(), _modifiedColumns.end()};
+}
+
+void World::takeDirtySections(std::vector<glm::ivec3> &out) {
+    out.insert(out.end(), _dirtySections.begin(), _dirtySections.end());
+    _dirtySections.clear();
+}
+
+void World::takeChangedBlocks(std::vector<glm::ivec3> &out) {
+    out.insert(out.end(), _changedBlocks.begin(), _changedBlocks.end());
+    _changedBlocks.clear();
+}
+
+std::size_t World::sectionCount() const {
+    return _sections.size();
+}
+
+std::shared_mutex &World::mutex() const {
+    return _mutex;
+}
+
+WorldMemoryReport World::memoryReport() const {
+    WorldMemoryReport report;
+    report.sectionCount = _sections.size();
+    // the map itself: one node per section plus the bucket array
+    report.totalBytes = _sections.bucket_count() * sizeof(void *)
+        + _sections.size() * (sizeof(std::pair<const glm::ivec3, std::unique_ptr<ChunkSection>>) + sizeof(void *));
+    for (const auto &[pos, section] : _sections) {
+        report.totalBytes += section->memoryUsage();
+        switch (section->bitsPerBlock()) {
+            case 0: report.sectionsByBits[0]++; break;
+            case 1: report.sectionsByBits[1]++; break;
+            case 2: report.sectionsByBits[2]++; break;
+            case 4: report.sectionsByBits[3]++; break;
+            case 8: report.sectionsByBits[4]++; break;
+            default: report.sectionsByBits[5]++; break;
+        }
+    }
+    return report;
+}
+
+glm::ivec3 World::toSectionPos(const glm::ivec3 &blockPos) {
+    // arithmetic shift rounds towards negative infinity, unlike division
+    return {blockPos.x >> 4, blockPos.y >> 4, blockPos.z >> 4};
+}
+
+glm::ivec3 World::toLocalPos(const glm::ivec3 &blockPos) {
+    return {blockPos.x & 15, blockPos.y & 15, blockPos.z & 15};
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "Block.h"
+#include "ChunkSection.h"
+
+struct SectionPosHash {
+    std::size_t operator()(const glm::ivec3 &pos) const {
+        // large primes spread neighbouring sections over different buckets
+        auto x = static_cast<std::size_t>(static_cast<unsigned int>(pos.x)) * 73856093u;
+        auto y = static_cast<std::size_t>(static_cast<unsigned int>(pos.y)) * 19349663u;
+        auto z = static_cast<std::size_t>(static_cast<unsigned int>(pos.z)) * 83492791u;
+        return x ^ y ^ z;
+    }
+};
+
+struct ColumnPosHash {
+    std::size_t operator()(const glm::ivec2 &pos) const {
+        auto x = static_cast<std::size_t>(static_cast<unsigned int>(pos.x)) * 73856093u;
+        auto z = static_cast<std::size_t>(static_cast<unsigned int>(pos.y)) * 83492791u;
+        return x ^ z;
+    }
+};
+
+struct WorldMemoryReport {
+    std::size_t sectionCount{0};
+    std::size_t totalBytes{0};
+    // number of sections using 0, 1, 2, 4, 8 and 16 bits per block respectively
+    std::size_t sectionsByBits[6]{};
+
+    std::size_t bytesPerSection() const;
+};
+
+std::ostream &operator<<(std::ostream &stream, const WorldMemoryReport &report);
+
+// World doesn't lock anything itself. Once jobs are touching it, readers hold the mutex shared and
+// writers hold it exclusively.
+class World {
+public:
+    // sections per chunk column, stacked upwards from y = 0
+    static constexpr int COLUMN_SECTIONS = 8;
+    // in blocks, so world y goes from 0 to HEIGHT - 1
+    static constexpr int HEIGHT = COLUMN_SECTIONS * ChunkSection::SIZE;
+    // a column of sections from the bottom up. missing sections are all air.
+    using Column = std::array<std::unique_ptr<ChunkSection>, COLUMN_SECTIONS>;
+    using ColumnView = std::array<const ChunkSection *, COLUMN_SECTIONS>;
+
+private:
+    std::unordered_map<glm::ivec3, std::unique_ptr<ChunkSection>, SectionPosHash> _sections{};
+    // columns changed since they were last saved
+    std::unordered_set<glm::ivec2, ColumnPosHash> _modifiedColumns{};
+    // sections that need a new mesh because of setBlock. a set, so any number of edits to one section
+    // only remesh it once.
+    std::unordered_set<glm::ivec3, SectionPosHash> _dirtySections{};
+    // every block changed by setBlock, for relighting
+    std::vector<glm::ivec3> _changedBlocks{};
+    mutable std::shared_mutex _mutex{};
+
+public:
+    // returns air for blocks in sections that aren't loaded
+    BlockId getBlock(const glm::ivec3 &pos) const;
+    // marks the column as modified and the block as dirty. blocks above or below the world are ignored,
+    // their sections would never be meshed, saved or unloaded.
+    void setBlock(const glm::ivec3 &pos, BlockId block);
+    // marks the block's section, plus any neighbour section sharing the block's faces, as needing a new
+    // mesh. for anything that changes how a block looks without setBlock, like light.
+    void markDirty(const glm::ivec3 &pos);
+
+    ChunkSection *getSection(const glm::ivec3 &sectionPos);
+    const ChunkSection *getSection(const glm::ivec3 &sectionPos) const;
+    ChunkSection &getOrCreateSection(const glm::ivec3 &sectionPos);
+    void setSection(const glm::ivec3 &sectionPos, std::unique_ptr<ChunkSection> section);
+    void removeSection(const glm::ivec3 &sectionPos);
+
+    // moves every section of the column into the world, replacing what was there
+    void setColumn(int chunkX, int chunkZ, Column column);
+    // removes the column from the world and hands its sections back
+    Column takeColumn(int chunkX, int chunkZ);
+    ColumnView getColumn(int chunkX, int chunkZ) const;
+
+    bool isColumnModified(int chunkX, int chunkZ) const;
+    void clearModified(int chunkX, int chunkZ);
+    std::vector<glm::ivec2> modifiedColumns() const;
+    // appends every dirty section to out and clears them
+    void takeDirtySections(std::vector<glm::ivec3> &out);
+    // appends the position of every block changed by setBlock since the last call to out
+    void takeChangedBlocks(std::vector<glm::ivec3> &out);
+
+    std::size_t sectionCount() const;
+    std::shared_mutex &mutex() const;
+    WorldMemoryReport memoryReport() const;
+
+    static glm::ivec3 toSectionPos(const glm::ivec3 &blockPos);
+    static glm::ivec3 toLocalPos(const glm::ivec3 &blockPos);
+};
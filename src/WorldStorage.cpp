@@ -0,0 +1,70 @@
+#include "WorldStorage.h"
+
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::uint8_t COLUMN_FORMAT_VERSION = 1;
+
+    // reused between calls so loading doesn't allocate once the buffers have grown
+    thread_local std::vector<std::uint8_t> columnBuffer;
+}
+
+WorldStorage::WorldStorage(const std::string &directory) : _directory(directory) {
+    fs::create_directories(directory);
+}
+
+bool WorldStorage::loadColumn(int chunkX, int chunkZ, World::Column &column) {
+    if (!region(chunkX, chunkZ).read(chunkX & (RegionFile::SIZE - 1), chunkZ & (RegionFile::SIZE - 1), columnBuffer)) {
+        return false;
+    }
+
+    // version, a bit per present section from the bottom up, then the sections themselves
+    const std::uint8_t *data = columnBuffer.data();
+    const std::uint8_t *end = data + columnBuffer.size();
+    if (columnBuffer.size() < 2 || data[0] != COLUMN_FORMAT_VERSION) {
+        throw std::runtime_error("Could not load column (" + std::to_string(chunkX) + ", " + std::to_string(chunkZ)
+            + "): unknown format");
+    }
+    std::uint8_t sectionMask = data[1];
+    data += 2;
+    for (int sectionY = 0; sectionY < World::COLUMN_SECTIONS; sectionY++) {
+        if (sectionMask & (1u << sectionY)) {
+            column[sectionY] = ChunkSection::deserialize(data, end);
+        } else {
+            column[sectionY].reset();
+        }
+    }
+    return true;
+}
+
+void WorldStorage::saveColumn(int chunkX, int chunkZ, const World::ColumnView &column) {
+    static_assert(World::COLUMN_SECTIONS <= 8, "the section mask has to fit in a byte");
+
+    columnBuffer.clear();
+    columnBuffer.push_back(COLUMN_FORMAT_VERSION);
+    columnBuffer.push_back(0);
+    for (int sectionY = 0; sectionY < World::COLUMN_SECTIONS; sectionY++) {
+        if (column[sectionY] && !column[sectionY]->isEmpty()) {
+            columnBuffer[1] |= static_cast<std::uint8_t>(1u << sectionY);
+            column[sectionY]->serialize(columnBuffer);
+        }
+    }
+    region(chunkX, chunkZ).write(chunkX & (RegionFile::SIZE - 1), chunkZ & (RegionFile::SIZE - 1),
+        columnBuffer.data(), columnBuffer.size());
+}
+
+RegionFile &WorldStorage::region(int chunkX, int chunkZ) {
+    static_assert(RegionFile::SIZE == 32, "region coordinates are chunk coordinates shifted right by 5");
+    glm::ivec2 regionPos(chunkX >> 5, chunkZ >> 5);
+    std::lock_guard<std::mutex> lock(_regionsMutex);
+    auto &region = _regions[regionPos];
+    if (!region) {
+        auto fileName = "r." + std::to_string(regionPos.x) + "." + std::to_string(regionPos.y) + ".bgr";
+        region = std::make_unique<RegionFile>(fs::path(_directory).append(fileName).string());
+    }
+    return *region;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <glm/vec2.hpp>
+
+#include "RegionFile.h"
+#include "World.h"
+
+// Saves and loads chunk columns, spread over region files in one directory. Thread safe.
+class WorldStorage {
+private:
+    std::string _directory;
+    std::mutex _regionsMutex{};
+    std::unordered_map<glm::ivec2, std::unique_ptr<RegionFile>, ColumnPosHash> _regions{};
+
+public:
+    // creates the directory if it doesn't exist
+    explicit WorldStorage(const std::string &directory);
+
+    // returns false if the column was never saved
+    bool loadColumn(int chunkX, int chunkZ, World::Column &column);
+    void saveColumn(int chunkX, int chunkZ, const World::ColumnView &column);
+
+private:
+    RegionFile &region(int chunkX, int chunkZ);
+};
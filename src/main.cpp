@@ -1,28 +1,94 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "Window.h"
+#include "FrameStats.h"
 #include "Game.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+namespace {
+    void printUsage() {
+        std::cerr << "usage: BlockGame [--trace] [--frame-stats <file>] [--hitch <ms>]...\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    Profiler::setThreadName("main");
+    // --trace captures from the very start, until F3 is pressed or the game closes.
+    // --frame-stats <file> writes frame time percentiles there as they come in, see FrameStats.
+    // each --hitch <ms> replaces the default hitch thresholds.
+    FrameStats::Config statsConfig;
+    bool hitchesGiven = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            Profiler::start();
+        } else if (std::strcmp(argv[i], "--frame-stats") == 0 && hasValue) {
+            statsConfig.outputPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--hitch") == 0 && hasValue) {
+            if (!hitchesGiven) {
+                statsConfig.hitchMilliseconds.clear();
+                hitchesGiven = true;
+            }
+            // std::stod throws on garbage but happily stops at trailing junk, and takes "nan" and "inf"
+            const char *text = argv[++i];
+            std::size_t parsed = 0;
+            double milliseconds = 0.0;
+            try {
+                milliseconds = std::stod(text, &parsed);
+            } catch (const std::exception &exception) {
+                parsed = 0;
+            }
+            if (parsed == 0 || text[parsed] != '\0' || !std::isfinite(milliseconds) || milliseconds <= 0.0) {
+                std::cerr << "--hitch needs a positive number of milliseconds, not \"" << text << "\"\n";
+                printUsage();
+                return 1;
+            }
+            statsConfig.hitchMilliseconds.push_back(milliseconds);
+        }
+    }
 
-int main() {
     Window window(800, 600, "Block Game");
     Game game;
+    FrameStats frameStats(statsConfig);
 
     float lastFrame = 0.0f;
     float deltaTime;
     while (!window.shouldClose()) {
+        Profiler::Zone zone("frame");
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        frameStats.beginFrame(deltaTime);
 
         if (window.isResized()) {
-            glViewport(0, 0, window.width(), window.height());
+            GLState::viewport(0, 0, window.width(), window.height());
             window.setResized(false);
         }
 
         game.processInput(window, deltaTime);
+        frameStats.lap(FramePhase::INPUT);
         game.update(deltaTime);
+        frameStats.lap(FramePhase::UPDATE);
         game.render();
+        frameStats.lap(FramePhase::RENDER);
         window.update();
+        frameStats.lap(FramePhase::PRESENT);
+    }
+
+    FrameStats::Summary session = frameStats.finish();
+    const FrameStats::PhaseSummary &frames = session.phases[static_cast<std::size_t>(FramePhase::FRAME)];
+    std::cout << "Frames: " << frames.count << ", p50 " << frames.p50 << " ms, p95 " << frames.p95 << " ms, p99 "
+        << frames.p99 << " ms, max " << frames.max << " ms";
+    for (std::size_t i = 0; i < session.hitches.size(); i++) {
+        std::cout << ", " << session.hitches[i] << " over " << statsConfig.hitchMilliseconds[i] << " ms";
     }
+    std::cout << std::endl;
 }